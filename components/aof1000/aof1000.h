@@ -4,6 +4,7 @@
 #include "esphome/core/automation.h"
 #include "esphome/components/sensor/sensor.h"
 #include "esphome/components/uart/uart.h"
+#include "esphome/components/uart_transaction/uart_transaction.h"
 
 namespace esphome {
 namespace aof1000 {
@@ -11,6 +12,7 @@ namespace aof1000 {
 class AOF1000Component : public PollingComponent, public uart::UARTDevice {
  public:
   void setup() override;
+  void loop() override { this->transaction_.loop(); }
   float get_setup_priority() const override { return setup_priority::DATA; }
   void update() override;
   void dump_config() override;
@@ -24,7 +26,7 @@ class AOF1000Component : public PollingComponent, public uart::UARTDevice {
   sensor::Sensor *o2_sensor_{nullptr};
   sensor::Sensor *volume_flow_rate_sensor_{nullptr};
   sensor::Sensor *temperature_sensor_{nullptr};
-  uint8_t buffer[12];
+  uart_transaction::UARTTransaction transaction_{this};
 };
 
 }
@@ -10,6 +10,7 @@ from esphome.const import (
 
 CODEOWNERS = ["@synodriver"]
 DEPENDENCIES = ["uart"]
+AUTO_LOAD = ["uart_transaction"]
 
 aof1000 = cg.esphome_ns.namespace("aof1000")
 AOF1000Component = aof1000.class_("AOF1000Component", cg.PollingComponent, uart.UARTDevice)
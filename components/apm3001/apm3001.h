@@ -4,6 +4,7 @@
 #include "esphome/core/automation.h"
 #include "esphome/components/sensor/sensor.h"
 #include "esphome/components/uart/uart.h"
+#include "esphome/components/uart_transaction/uart_transaction.h"
 
 namespace esphome {
 namespace apm3001 {
@@ -11,6 +12,7 @@ namespace apm3001 {
 class APM3001Component : public PollingComponent, public uart::UARTDevice {
  public:
   void setup() override;
+  void loop() override { this->transaction_.loop(); }
   float get_setup_priority() const override {return setup_priority::DATA;}
   void update() override;
   void dump_config() override;
@@ -24,6 +26,7 @@ class APM3001Component : public PollingComponent, public uart::UARTDevice {
   sensor::Sensor *pm2_5_sensor_{nullptr};
   sensor::Sensor *pm4_sensor_{nullptr};
   sensor::Sensor *pm10_sensor_{nullptr};
+  uart_transaction::UARTTransaction transaction_{this};
 
   void start_measurement();
   void stop_measurement();
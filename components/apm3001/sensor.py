@@ -17,6 +17,7 @@ from esphome.const import (
 
 CODEOWNERS = ["@synodriver"]
 DEPENDENCIES = ["uart"]
+AUTO_LOAD = ["uart_transaction"]
 
 apm3001 = cg.esphome_ns.namespace("apm3001")
 APM3001Component = apm3001.class_("APM3001Component", cg.PollingComponent, uart.UARTDevice)
@@ -1,341 +1,663 @@
 #include "bl0910.h"
 #include "constants.h"
-#include <queue>
+#include <algorithm>
+#include <cmath>
 #include "esphome/core/log.h"
 
 namespace esphome {
 namespace bl0910 {
 // 定义日志标签为 "bl0910"
 static const char *const TAG = "bl0910";
-// 将 ube24_t 类型的三个字节数据转换为 uint32_t 类型
-constexpr uint32_t to_uint32_t(ube24_t input) { return input.h << 16 | input.m << 8 | input.l; }
-// 将 sbe24_t 类型的三个字节数据转换为 int32_t 类型
-constexpr int32_t to_int32_t(sbe24_t input) { return input.h << 16 | input.m << 8 | input.l; }
+// 将三个数据字节转换为无符号 24 位整数
+constexpr uint32_t to_uint32_t(const DataPacket &input) { return input.h << 16 | input.m << 8 | input.l; }
+// 将三个数据字节转换为有符号 24 位整数（最高字节符号扩展）
+constexpr int32_t to_int32_t(const DataPacket &input) { return int8_t(input.h) * 65536 + (input.m << 8 | input.l); }
 // 校验和计算函数，计算地址和数据字节的校验和
 constexpr uint8_t bl0910_checksum(const uint8_t address, const DataPacket *data) {
   return (address + data->l + data->m + data->h) ^ 0xFF;
 }
 
-// 主循环，读取数据并处理不同通道的数据
+// 按寄存器类型特化的换算函数
+template<RegisterKind K> float convert_register(const DataPacket &data, float scale);
+template<> float convert_register<REGISTER_KIND_UNSIGNED>(const DataPacket &data, float scale) {
+  return (float) to_uint32_t(data) * scale;
+}
+template<> float convert_register<REGISTER_KIND_SIGNED>(const DataPacket &data, float scale) {
+  return (float) to_int32_t(data) * scale;
+}
+template<> float convert_register<REGISTER_KIND_TEMPERATURE>(const DataPacket &data, float scale) {
+  return (float) (to_int32_t(data) - 64) * scale - 40;
+}
+template<> float convert_register<REGISTER_KIND_PERIOD>(const DataPacket &data, float scale) {
+  uint32_t period = to_uint32_t(data);
+  return period == 0 ? NAN : scale / (float) period;
+}
+// 以 RegisterKind 为下标的换算函数表
+static const ConvertFunc CONVERTERS[] = {
+    convert_register<REGISTER_KIND_UNSIGNED>,
+    convert_register<REGISTER_KIND_SIGNED>,
+    convert_register<REGISTER_KIND_TEMPERATURE>,
+    convert_register<REGISTER_KIND_PERIOD>,
+};
+
+// 各通道的寄存器地址与换算系数
+BL0910::BL0910()
+    : channels_{{
+          {BL0910_I_1_RMS, BL0910_WATT_1, BL0910_CF_1_CNT, BL0910_RMSGN_1, BL0910_RMSOS_1,
+           BL0910_IREF, BL0910_PREF, BL0910_EREF},
+          {BL0910_I_2_RMS, BL0910_WATT_2, BL0910_CF_2_CNT, BL0910_RMSGN_2, BL0910_RMSOS_2,
+           BL0910_IREF, BL0910_PREF, BL0910_EREF},
+          {BL0910_I_3_RMS, BL0910_WATT_3, BL0910_CF_3_CNT, BL0910_RMSGN_3, BL0910_RMSOS_3,
+           BL0910_IREF, BL0910_PREF, BL0910_EREF},
+          {BL0910_I_4_RMS, BL0910_WATT_4, BL0910_CF_4_CNT, BL0910_RMSGN_4, BL0910_RMSOS_4,
+           BL0910_IREF, BL0910_PREF, BL0910_EREF},
+          {BL0910_I_5_RMS, BL0910_WATT_5, BL0910_CF_5_CNT, BL0910_RMSGN_5, BL0910_RMSOS_5,
+           BL0910_IREF, BL0910_PREF, BL0910_EREF},
+          {BL0910_I_6_RMS, BL0910_WATT_6, BL0910_CF_6_CNT, BL0910_RMSGN_6, BL0910_RMSOS_6,
+           BL0910_IREF, BL0910_PREF, BL0910_EREF},
+          {BL0910_I_7_RMS, BL0910_WATT_7, BL0910_CF_7_CNT, BL0910_RMSGN_7, BL0910_RMSOS_7,
+           BL0910_IREF, BL0910_PREF, BL0910_EREF},
+          {BL0910_I_8_RMS, BL0910_WATT_8, BL0910_CF_8_CNT, BL0910_RMSGN_8, BL0910_RMSOS_8,
+           BL0910_IREF, BL0910_PREF, BL0910_EREF},
+          {BL0910_I_9_RMS, BL0910_WATT_9, BL0910_CF_9_CNT, BL0910_RMSGN_9, BL0910_RMSOS_9,
+           BL0910_IREF, BL0910_PREF, BL0910_EREF},
+          {BL0910_I_10_RMS, BL0910_WATT_10, BL0910_CF_10_CNT, BL0910_RMSGN_10, BL0910_RMSOS_10,
+           BL0910_IREF, BL0910_PREF, BL0910_EREF},
+      }} {}
+
+// 主循环：非阻塞地收取已到达的响应并补发读取命令，数据未到达时立即返回
 void BL0910::loop() {
-  // 如果 current_channel_ 为 UINT8_MAX，则直接返回
-  if (this->current_channel_ == UINT8_MAX) {
-    return;
+  this->receive_responses_();
+
+  // 排队的动作在流水线排空后执行，避免打断在途的读取；扫描在动作执行完之后继续
+  if (!this->verify_active_ && this->in_flight_count_ == 0) {
+    this->handle_actions_();
   }
 
-  this->flush();  // 清除串口缓冲区，避免残留数据干扰
+  if (this->capture_enabled_() && millis() - this->capture_window_start_ >= this->capture_window_) {
+    this->publish_capture_window_();
+  }
 
-  // 根据当前通道读取不同的传感器数据
-  switch (this->current_channel_) {
-    case 0:
-      this->read_data_(BL0910_TEMPERATURE, BL0910_TREF, this->temperature_sensor_);  // Temperature
-      break;
-    case 1:
-      this->read_data_(BL0910_I_1_RMS, BL0910_IREF, this->current_1_sensor_);
-      this->read_data_(BL0910_WATT_1, BL0910_PREF, this->power_1_sensor_);
-      this->read_data_(BL0910_CF_1_CNT, BL0910_EREF, this->energy_1_sensor_);
-      this->calculate_power_factor_(this->current_1_sensor_, this->voltage_sensor_, this->power_1_sensor_,
-                                    this->power_factor_1_sensor_);
-      break;
-    case 2:
-      this->read_data_(BL0910_I_2_RMS, BL0910_IREF, this->current_2_sensor_);
-      this->read_data_(BL0910_WATT_2, BL0910_PREF, this->power_2_sensor_);
-      this->read_data_(BL0910_CF_2_CNT, BL0910_EREF, this->energy_2_sensor_);
-      this->calculate_power_factor_(this->current_2_sensor_, this->voltage_sensor_, this->power_2_sensor_,
-                                    this->power_factor_2_sensor_);
-      break;
-    case 3:
-      this->read_data_(BL0910_I_3_RMS, BL0910_IREF, this->current_3_sensor_);
-      this->read_data_(BL0910_WATT_3, BL0910_PREF, this->power_3_sensor_);
-      this->read_data_(BL0910_CF_3_CNT, BL0910_EREF, this->energy_3_sensor_);
-      this->calculate_power_factor_(this->current_3_sensor_, this->voltage_sensor_, this->power_3_sensor_,
-                                    this->power_factor_3_sensor_);
-      break;
-    case 4:
-      this->read_data_(BL0910_I_4_RMS, BL0910_IREF, this->current_4_sensor_);
-      this->read_data_(BL0910_WATT_4, BL0910_PREF, this->power_4_sensor_);
-      this->read_data_(BL0910_CF_4_CNT, BL0910_EREF, this->energy_4_sensor_);
-      this->calculate_power_factor_(this->current_4_sensor_, this->voltage_sensor_, this->power_4_sensor_,
-                                    this->power_factor_4_sensor_);
-      break;
-    case 5:
-      this->read_data_(BL0910_I_5_RMS, BL0910_IREF, this->current_5_sensor_);
-      this->read_data_(BL0910_WATT_5, BL0910_PREF, this->power_5_sensor_);
-      this->read_data_(BL0910_CF_5_CNT, BL0910_EREF, this->energy_5_sensor_);
-      this->calculate_power_factor_(this->current_5_sensor_, this->voltage_sensor_, this->power_5_sensor_,
-                                    this->power_factor_5_sensor_);
-      break;
-    case 6:
-      this->read_data_(BL0910_I_6_RMS, BL0910_IREF, this->current_6_sensor_);
-      this->read_data_(BL0910_WATT_6, BL0910_PREF, this->power_6_sensor_);
-      this->read_data_(BL0910_CF_6_CNT, BL0910_EREF, this->energy_6_sensor_);
-      this->calculate_power_factor_(this->current_6_sensor_, this->voltage_sensor_, this->power_6_sensor_,
-                                    this->power_factor_6_sensor_);
-      break;
-    case 7:
-      this->read_data_(BL0910_I_7_RMS, BL0910_IREF, this->current_7_sensor_);
-      this->read_data_(BL0910_WATT_7, BL0910_PREF, this->power_7_sensor_);
-      this->read_data_(BL0910_CF_7_CNT, BL0910_EREF, this->energy_7_sensor_);
-      this->calculate_power_factor_(this->current_7_sensor_, this->voltage_sensor_, this->power_7_sensor_,
-                                    this->power_factor_7_sensor_);
-      break;
-    case 8:
-      this->read_data_(BL0910_I_8_RMS, BL0910_IREF, this->current_8_sensor_);
-      this->read_data_(BL0910_WATT_8, BL0910_PREF, this->power_8_sensor_);
-      this->read_data_(BL0910_CF_8_CNT, BL0910_EREF, this->energy_8_sensor_);
-      this->calculate_power_factor_(this->current_8_sensor_, this->voltage_sensor_, this->power_8_sensor_,
-                                    this->power_factor_8_sensor_);
-      break;
-    case 9:
-      this->read_data_(BL0910_I_9_RMS, BL0910_IREF, this->current_9_sensor_);
-      this->read_data_(BL0910_WATT_9, BL0910_PREF, this->power_9_sensor_);
-      this->read_data_(BL0910_CF_9_CNT, BL0910_EREF, this->energy_9_sensor_);
-      this->calculate_power_factor_(this->current_9_sensor_, this->voltage_sensor_, this->power_9_sensor_,
-                                    this->power_factor_9_sensor_);
-      break;
-    case 10:
-      this->read_data_(BL0910_I_10_RMS, BL0910_IREF, this->current_10_sensor_);
-      this->read_data_(BL0910_WATT_10, BL0910_PREF, this->power_10_sensor_);
-      this->read_data_(BL0910_CF_10_CNT, BL0910_EREF, this->energy_10_sensor_);
-      this->calculate_power_factor_(this->current_10_sensor_, this->voltage_sensor_, this->power_10_sensor_,
-                                    this->power_factor_10_sensor_);
-      break;
-    case (UINT8_MAX - 2):
-      this->read_data_(BL0910_FREQUENCY, BL0910_FREF, this->frequency_sensor_);  // Frequency
-      this->read_data_(BL0910_V_RMS, BL0910_UREF, this->voltage_sensor_);        // Voltage
-      break;
-    case (UINT8_MAX - 1):
-      this->read_data_(BL0910_WATT_SUM, BL0910_WATT, this->total_power_sensor_);   // Total power
-      this->read_data_(BL0910_CF_SUM_CNT, BL0910_CF, this->total_energy_sensor_);  // Total Energy
+  this->send_requests_();
+
+  if (this->verify_active_ && this->verify_index_ >= this->verify_entries_.size() && this->in_flight_count_ == 0) {
+    this->finish_verification_();
+  }
+
+  // 所有命令都已发出且响应全部处理完毕，本轮扫描结束
+  if (this->sweep_active_ && this->schedule_index_ >= this->schedule_.size() && this->in_flight_count_ == 0) {
+    this->finish_sweep_();
+  }
+}
+
+// 补发读取命令直到在途命令数达到流水线深度：校准回读最先，其次扫描，扫描空闲时进行快速采集
+void BL0910::send_requests_() {
+  while (this->in_flight_count_ < this->pipeline_depth_) {
+    if (this->verify_active_) {
+      if (this->verify_index_ >= this->verify_entries_.size()) {
+        return;
+      }
+      this->send_request_(&this->verify_entries_[this->verify_index_++]);
+    } else if (!this->action_queue_.empty()) {
+      // 有排队的动作时暂停扫描与采集，让流水线排空后执行动作
+      return;
+    } else if (this->sweep_active_) {
+      if (this->schedule_index_ >= this->schedule_.size()) {
+        return;
+      }
+      this->send_request_(&this->schedule_[this->schedule_index_++]);
+    } else if (this->capture_enabled_()) {
+      this->send_request_(&this->capture_entries_[this->capture_next_]);
+      this->capture_next_ = (this->capture_next_ + 1) % this->capture_entries_.size();
+    } else {
+      return;
+    }
+  }
+}
+
+// 发送一条读取命令，只写入串口发送缓冲区，不等待响应
+void BL0910::send_request_(const ScheduleEntry *entry) {
+  // 没有在途命令时丢弃残留字节，避免与本次响应错位
+  if (this->in_flight_count_ == 0) {
+    this->drain_rx_();
+  }
+  this->write_byte(BL0910_READ_COMMAND);
+  this->write_byte(entry->address);
+  uint8_t slot = (this->in_flight_head_ + this->in_flight_count_) % BL0910_MAX_PIPELINE_DEPTH;
+  this->in_flight_[slot] = entry;
+  this->in_flight_count_++;
+  this->last_activity_ = millis();
+}
+
+// 按发送顺序处理已到齐的响应，并以校验和确认响应对应的寄存器地址
+void BL0910::receive_responses_() {
+  while (this->in_flight_count_ > 0 && this->available() >= (int) sizeof(DataPacket)) {
+    DataPacket buffer;
+    if (!this->read_array((uint8_t *) &buffer, sizeof(buffer))) {
       break;
-    default:
-      this->current_channel_ = UINT8_MAX - 2;  // Go to frequency and voltage
+    }
+    this->last_activity_ = millis();
+
+    // 正常情况下响应属于最早发送的命令；若某条响应丢失，则在后续在途命令中寻找校验和匹配的一条
+    uint8_t match = 0;
+    while (match < this->in_flight_count_) {
+      const ScheduleEntry &entry = this->in_flight_entry_(match);
+      if (bl0910_checksum(entry.address, &buffer) == buffer.checksum) {
+        break;
+      }
+      match++;
+    }
+    if (match == this->in_flight_count_) {
+      // 没有任何在途命令与之匹配，字节流已错位：丢弃所有在途命令，剩余读取留待下一轮
+      ESP_LOGW(TAG, "Checksum failed. Discarding %u pending reads.", this->in_flight_count_);
+      this->status_set_warning();
+      this->drop_in_flight_(this->in_flight_count_);
+      this->drain_rx_();
       return;
+    }
+    if (match > 0) {
+      ESP_LOGW(TAG, "Lost %u responses, resynchronized on register 0x%02X.", match,
+               this->in_flight_entry_(match).address);
+      this->drop_in_flight_(match);
+    }
+    this->publish_data_(this->in_flight_entry_(0), buffer);
+    this->drop_in_flight_(1);
+  }
+
+  if (this->in_flight_count_ > 0 && millis() - this->last_activity_ >= BL0910_READ_TIMEOUT_MS) {
+    ESP_LOGW(TAG, "Timeout reading register 0x%02X, skipping.", this->in_flight_entry_(0).address);
+    this->status_set_warning();
+    this->drop_in_flight_(1);
+    this->last_activity_ = millis();
   }
-  // 递增通道并处理后续操作
-  this->current_channel_++;
-  this->handle_actions_();
+}
+
+// 从在途队列头部移除 count 条命令
+void BL0910::drop_in_flight_(uint8_t count) {
+  this->in_flight_head_ = (this->in_flight_head_ + count) % BL0910_MAX_PIPELINE_DEPTH;
+  this->in_flight_count_ -= count;
+  this->stale_in_flight_ = this->stale_in_flight_ > count ? this->stale_in_flight_ - count : 0;
+}
+
+// 本轮扫描结束：根据本轮读数快照计算派生量
+void BL0910::finish_sweep_() {
+  this->sweep_active_ = false;
+  this->commit_energy_();
+  this->compute_derived_metrics_();
+}
+
+// 根据已配置的传感器生成扫描调度表，扫描开销只与实际配置的传感器数量相关。
+// 派生量所需的电压、电流、功率即使没有配置对应传感器也会读取（只进快照，不发布）。
+// 电压排在各通道之前，派生量计算使用的是同一轮扫描的电压值。
+void BL0910::build_schedule_() {
+  this->schedule_.clear();
+  this->active_channels_.clear();
+  for (uint8_t channel = 0; channel < BL0910_NUM_CHANNELS; channel++) {
+    if (this->has_derived_sensors_(this->channels_[channel])) {
+      this->active_channels_.push_back(channel);
+    }
+  }
+  bool derived = !this->active_channels_.empty();
+
+  this->add_schedule_entry_(BL0910_FREQUENCY, REGISTER_KIND_PERIOD, BL0910_FREF, this->frequency_sensor_);
+  this->add_schedule_entry_(BL0910_V_RMS, REGISTER_KIND_UNSIGNED, BL0910_UREF, this->voltage_sensor_,
+                            derived ? &this->voltage_snapshot_ : nullptr);
+  this->add_schedule_entry_(BL0910_TEMPERATURE, REGISTER_KIND_TEMPERATURE, BL0910_TREF, this->temperature_sensor_);
+  for (uint8_t channel = 0; channel < BL0910_NUM_CHANNELS; channel++) {
+    const ChannelDescriptor &descriptor = this->channels_[channel];
+    ChannelSnapshot &snapshot = this->snapshot_[channel];
+    bool channel_derived = this->has_derived_sensors_(descriptor);
+    this->add_schedule_entry_(descriptor.current_address, REGISTER_KIND_UNSIGNED, descriptor.current_scale,
+                              descriptor.current_sensor, channel_derived ? &snapshot.current : nullptr);
+    this->add_schedule_entry_(descriptor.power_address, REGISTER_KIND_SIGNED, descriptor.power_scale,
+                              descriptor.power_sensor, channel_derived ? &snapshot.power : nullptr);
+    this->add_schedule_entry_(descriptor.energy_address, REGISTER_KIND_UNSIGNED, descriptor.energy_scale,
+                              descriptor.energy_sensor, nullptr, channel);
+  }
+  this->add_schedule_entry_(BL0910_WATT_SUM, REGISTER_KIND_SIGNED, BL0910_WATT, this->total_power_sensor_);
+  this->add_schedule_entry_(BL0910_CF_SUM_CNT, REGISTER_KIND_UNSIGNED, BL0910_CF, this->total_energy_sensor_,
+                            nullptr, BL0910_TOTAL_ENERGY_COUNTER);
+}
+
+// 为已配置的传感器或派生量所需的读数添加调度表项，换算函数按寄存器类型在此一次性选定
+void BL0910::add_schedule_entry_(uint8_t address, RegisterKind kind, float scale, sensor::Sensor *sensor,
+                                 float *snapshot, uint8_t energy_counter) {
+  if (sensor != nullptr || snapshot != nullptr) {
+    this->schedule_.push_back({address, CONVERTERS[kind], scale, sensor, snapshot, energy_counter, false});
+  }
+}
+
+// 通道是否配置了任何派生量传感器（总视在/无功功率需要所有通道参与）
+bool BL0910::has_derived_sensors_(const ChannelDescriptor &descriptor) const {
+  return descriptor.power_factor_sensor != nullptr || descriptor.apparent_power_sensor != nullptr ||
+         descriptor.reactive_power_sensor != nullptr ||
+         ((this->total_apparent_power_sensor_ != nullptr || this->total_reactive_power_sensor_ != nullptr) &&
+          (descriptor.current_sensor != nullptr || descriptor.power_sensor != nullptr));
+}
+
+// 基于本轮扫描的快照计算各通道视在功率、无功功率、功率因数及其合计，不产生额外的串口通信
+void BL0910::compute_derived_metrics_() {
+  if (this->active_channels_.empty()) {
+    return;
+  }
+  const float voltage = this->voltage_snapshot_;
+  float total_apparent = 0;
+  float total_reactive = 0;
+  bool totals_valid = !std::isnan(voltage);
+  for (uint8_t channel : this->active_channels_) {
+    const ChannelDescriptor &descriptor = this->channels_[channel];
+    const ChannelSnapshot &snapshot = this->snapshot_[channel];
+    if (std::isnan(voltage) || std::isnan(snapshot.current) || std::isnan(snapshot.power)) {
+      totals_valid = false;
+      continue;
+    }
+    float apparent = voltage * snapshot.current;
+    float reactive = std::sqrt(std::max(apparent * apparent - snapshot.power * snapshot.power, 0.0f));
+    total_apparent += apparent;
+    total_reactive += reactive;
+    this->publish_with_deadband_(descriptor.apparent_power_sensor, apparent, this->power_deadband_);
+    this->publish_with_deadband_(descriptor.reactive_power_sensor, reactive, this->power_deadband_);
+    // 电流为零时功率因数没有意义，不发布
+    if (apparent > 0) {
+      this->publish_with_deadband_(descriptor.power_factor_sensor, snapshot.power / apparent,
+                                   this->power_factor_deadband_);
+    }
+  }
+  // 清空快照，读取失败的寄存器不会沿用上一轮的值
+  this->voltage_snapshot_ = NAN;
+  this->snapshot_.fill({});
+  if (totals_valid) {
+    this->publish_with_deadband_(this->total_apparent_power_sensor_, total_apparent, this->power_deadband_);
+    this->publish_with_deadband_(this->total_reactive_power_sensor_, total_reactive, this->power_deadband_);
+  }
+}
+
+// 与上次发布的值相差不超过 deadband 时不发布
+void BL0910::publish_with_deadband_(sensor::Sensor *sensor, float value, float deadband) {
+  if (sensor == nullptr) {
+    return;
+  }
+  if (deadband > 0 && sensor->has_state() && std::fabs(sensor->state - value) <= deadband) {
+    return;
+  }
+  sensor->publish_state(value);
 }
 
 // 初始化设置函数
 void BL0910::setup() {
-  this->flush();                                                      // 清空串口缓存
-  this->write_array(USR_SOFT_RESET, sizeof(USR_SOFT_RESET));          // 恢复初始化
-  this->write_array(USR_WRPROT_WITABLE, sizeof(USR_WRPROT_WITABLE));  // 解除写保护
-  // 校准 (1: 对应寄存器; 2: 校准前值; 3: 校准后值)
-  this->bias_correction_(BL0910_RMSOS_1, 0, 0);
-  this->bias_correction_(BL0910_RMSOS_2, 0, 0);
-  this->bias_correction_(BL0910_RMSOS_3, 0, 0);
-  this->bias_correction_(BL0910_RMSOS_4, 0, 0);
-  this->bias_correction_(BL0910_RMSOS_5, 0, 0);
-  this->bias_correction_(BL0910_RMSOS_6, 0, 0);
-  this->bias_correction_(BL0910_RMSOS_7, 0, 0);
-  this->bias_correction_(BL0910_RMSOS_8, 0, 0);
-  this->bias_correction_(BL0910_RMSOS_9, 0, 0);
-  this->bias_correction_(BL0910_RMSOS_10, 0, 0);
-  this->gain_correction_(BL0910_RMSGN_1, 1, 1);
-  this->gain_correction_(BL0910_RMSGN_2, 1, 1);
-  this->gain_correction_(BL0910_RMSGN_3, 1, 1);
-  this->gain_correction_(BL0910_RMSGN_4, 1, 1);
-  this->gain_correction_(BL0910_RMSGN_5, 1, 1);
-  this->gain_correction_(BL0910_RMSGN_6, 1, 1);
-  this->gain_correction_(BL0910_RMSGN_7, 1, 1);
-  this->gain_correction_(BL0910_RMSGN_8, 1, 1);
-  this->gain_correction_(BL0910_RMSGN_9, 1, 1);
-  this->gain_correction_(BL0910_RMSGN_10, 1, 1);
-}
-
-// 重置当前通道计数，触发下一次读取数据循环
-void BL0910::update() { this->current_channel_ = 0; }
-
-std::queue<ActionCallbackFuncPtr> enqueue_action_;
-// 将动作加入队列
-size_t BL0910::enqueue_action_(ActionCallbackFuncPtr function) {
-  this->action_queue_.push_back(function);
-  return this->action_queue_.size();
-}
-
-// 处理动作队列中的所有操作
+  this->build_schedule_();
+  this->build_capture_entries_();
+  // 恢复累计电量；芯片在下方被软复位，CF 计数从 0 开始
+  uint32_t hash = fnv1_hash(this->energy_preference_key_);
+  this->energy_pref_ = global_preferences->make_preference<EnergyTotals>(hash, true);
+  if (!this->energy_pref_.load(&this->energy_totals_)) {
+    this->energy_totals_ = {};
+  }
+  this->cf_counts_.fill(0);
+  this->last_energy_commit_ = millis();
+  this->drain_rx_();  // 丢弃上电时的残留字节
+  // 软复位与校准写入都交给动作队列，由 loop() 依次执行，两者之间至少隔一次 loop()，不在此阻塞等待
+  this->enqueue_action_(&BL0910::soft_reset_, 0);
+  this->enqueue_action_(&BL0910::restore_calibration_, 0);
+}
+
+// 从调度表开头开始新一轮扫描；上一轮尚未完成时，已发出的命令仍会被正常处理，但不进入本轮快照
+void BL0910::update() {
+  if (this->sweep_active_) {
+    ESP_LOGD(TAG, "Previous sweep incomplete, its readings are not used for derived metrics.");
+  }
+  this->schedule_index_ = 0;
+  this->sweep_active_ = true;
+  // 快照只保存本轮读到的值，派生量只对本轮完整读到电压、电流与功率的通道计算
+  this->voltage_snapshot_ = NAN;
+  this->snapshot_.fill({});
+  this->stale_in_flight_ = this->in_flight_count_;
+  // 扫描会打断快速采集，之后从电流重新开始配对，避免跨越扫描的电流与功率组成样本
+  this->capture_next_ = 0;
+  this->capture_current_ = NAN;
+}
+
+// 将动作加入队列，队列已满时丢弃并返回 false
+bool BL0910::enqueue_action_(ActionCallbackFuncPtr function, uint8_t argument) {
+  if (!this->action_queue_.push({function, argument})) {
+    ESP_LOGW(TAG, "Action queue full, dropping action.");
+    return false;
+  }
+  return true;
+}
+
+// 单通道重置电量：通道号来自模板值，运行时检查范围，越界的动作直接丢弃
+bool BL0910::enqueue_channel_reset_(uint8_t channel) {
+  if (channel < 1 || channel > BL0910_NUM_CHANNELS) {
+    ESP_LOGW(TAG, "reset_energy: invalid channel %u, expected 1..%u. Action dropped.", channel, BL0910_NUM_CHANNELS);
+    return false;
+  }
+  return this->enqueue_action_(&BL0910::reset_energy_, channel - 1);
+}
+
+// 每次 loop() 只执行一个排队的动作：软复位之后的写入落在下一次 loop()，芯片有时间完成复位
 void BL0910::handle_actions_() {
-  if (this->action_queue_.empty()) {
+  QueuedAction action;
+  if (!this->action_queue_.pop(action)) {
     return;
   }
-  ActionCallbackFuncPtr ptr_func = nullptr;
-  // 遍历所有动作并执行
-  for (int i = 0; i < this->action_queue_.size(); i++) {
-    ptr_func = this->action_queue_[i];
-    if (ptr_func) {
-      ESP_LOGI(TAG, "HandleActionCallback[%d]...", i);
-      (this->*ptr_func)();
-    }
+  (this->*action.function)(action.argument);
+  // 采集在动作前被暂停，从电流重新开始配对
+  this->capture_next_ = 0;
+  this->capture_current_ = NAN;
+}
+
+// 软复位：芯片寄存器回到默认值，写保护重新生效
+void BL0910::soft_reset_(uint8_t argument) {
+  this->write_array(USR_SOFT_RESET, sizeof(USR_SOFT_RESET));
+}
+
+// 复位后解除写保护并重新写入校准寄存器，写入后经流水线回读校验
+void BL0910::restore_calibration_(uint8_t argument) {
+  this->write_array(USR_WRPROT_WITABLE, sizeof(USR_WRPROT_WITABLE));
+  if (this->write_calibration_() > 0) {
+    this->verify_calibration_();
+  }
+}
+
+// Reset energy
+void BL0910::reset_energy_(uint8_t channel) {
+  if (channel != BL0910_ALL_CHANNELS && channel >= BL0910_NUM_CHANNELS) {
+    ESP_LOGW(TAG, "reset_energy: invalid channel index %u, ignored.", channel);
+    return;
   }
-  // 读取剩余数据并清空队列
+  if (channel != BL0910_ALL_CHANNELS) {
+    // 单个通道：只清零该通道的累计值，硬件计数不受影响
+    this->energy_totals_.pulses[channel] = 0;
+    this->energy_dirty_ = true;
+    ESP_LOGI(TAG, "Energy of channel %u reset.", channel + 1);
+    return;
+  }
+  // 软复位同时清除了写保护设置与校准寄存器，排队在下一次 loop() 重新写入
+  this->soft_reset_(0);
+  this->enqueue_action_(&BL0910::restore_calibration_, 0);
+  // 复位后硬件计数与累计值一起归零
+  this->cf_counts_.fill(0);
+  this->energy_totals_ = {};
+  this->energy_dirty_ = true;
+  ESP_LOGW(TAG, "Device reset with init command.");
+}
+
+// 丢弃串口接收缓冲区中的数据（非阻塞）
+void BL0910::drain_rx_() {
   while (this->available()) {
     this->read();
   }
+}
 
-  this->action_queue_.clear();
+// 换算并发布已通过校验的数据
+void BL0910::publish_data_(const ScheduleEntry &entry, const DataPacket &buffer) {
+  if (this->verify_active_) {
+    this->check_calibration_(entry, buffer);
+    return;
+  }
+  this->status_clear_warning();
+  if (entry.capture) {
+    this->store_capture_sample_(entry, entry.convert(buffer, entry.scale));
+    return;
+  }
+  float value;
+  if (entry.energy_counter != BL0910_NO_ENERGY_COUNTER) {
+    value = (float) this->accumulate_energy_(entry.energy_counter, to_uint32_t(buffer)) * entry.scale;
+  } else {
+    value = entry.convert(buffer, entry.scale);
+  }
+  if (entry.snapshot != nullptr && this->stale_in_flight_ == 0) {
+    *entry.snapshot = value;
+  }
+  if (entry.sensor != nullptr) {
+    entry.sensor->publish_state(value);
+  }
+}
 
-  // 处理完动作后清空缓冲区
-  this->flush();
+// 将 24 位 CF 计数的增量累加到 64 位累计值，返回累计脉冲数
+uint64_t BL0910::accumulate_energy_(uint8_t counter, uint32_t count) {
+  uint32_t delta = (count - this->cf_counts_[counter]) & BL0910_CF_COUNT_MASK;
+  // 增量超过量程一半说明计数器被复位（芯片复位或掉电）而不是正常回绕，从 0 重新计起
+  if (delta > BL0910_CF_COUNT_MASK / 2) {
+    ESP_LOGW(TAG, "Energy counter %u went back from %" PRIu32 " to %" PRIu32 ", assuming chip reset.", counter,
+             this->cf_counts_[counter], count);
+    delta = count;
+  }
+  this->cf_counts_[counter] = count;
+  if (delta != 0) {
+    this->energy_totals_.pulses[counter] += delta;
+    this->energy_dirty_ = true;
+  }
+  return this->energy_totals_.pulses[counter];
 }
 
-// Reset energy
-void BL0910::reset_energy_() {
-  // 写入初始化命令并清空缓冲区
-  this->write_array(BL0910_INIT[0], 6);
-  delay(1);
-  this->flush();
-  ESP_LOGW(TAG, "Device reset with init command.");
+// 生成快速采集使用的读取项
+void BL0910::build_capture_entries_() {
+  if (!this->capture_enabled_()) {
+    return;
+  }
+  const ChannelDescriptor &descriptor = this->channels_[this->capture_channel_];
+  this->capture_entries_[0] = {descriptor.current_address, CONVERTERS[REGISTER_KIND_UNSIGNED],
+                               descriptor.current_scale, nullptr, nullptr, BL0910_NO_ENERGY_COUNTER, true};
+  this->capture_entries_[1] = {descriptor.power_address, CONVERTERS[REGISTER_KIND_SIGNED], descriptor.power_scale,
+                               nullptr, nullptr, BL0910_NO_ENERGY_COUNTER, true};
+  this->capture_window_start_ = millis();
 }
 
-// Read data
-void BL0910::read_data_(const uint8_t address, const float reference, sensor::Sensor *sensor) {
-  if (sensor == nullptr) {
+// 电流读数先暂存，读到紧随其后的功率后组成一个样本写入环形缓冲区
+void BL0910::store_capture_sample_(const ScheduleEntry &entry, float value) {
+  if (&entry == &this->capture_entries_[0]) {
+    this->capture_current_ = value;
     return;
   }
+  if (std::isnan(this->capture_current_)) {
+    return;
+  }
+  this->capture_buffer_[this->capture_head_] = {millis(), this->capture_current_, value};
+  this->capture_head_ = (this->capture_head_ + 1) % BL0910_CAPTURE_BUFFER_SIZE;
+  if (this->capture_window_count_ < BL0910_CAPTURE_BUFFER_SIZE) {
+    this->capture_window_count_++;
+  }
+  this->capture_current_ = NAN;
+}
 
-  DataPacket buffer;
-  ube24_t data_u24;
-  sbe24_t data_s24;
-  float value = 0;
+// 发布当前窗口内样本的最小值、最大值与平均值；窗口内样本超过缓冲区容量时只统计最近的样本
+void BL0910::publish_capture_window_() {
+  this->capture_window_start_ = millis();
+  uint16_t count = this->capture_window_count_;
+  if (count == 0) {
+    return;
+  }
+  this->capture_window_count_ = 0;
 
-  // 判断数据类型是否为有符号
-  bool signed_result = reference == BL0910_TREF || reference == BL0910_WATT || reference == BL0910_PREF;
-  this->flush();
-  this->write_byte(BL0910_READ_COMMAND);
-  this->write_byte(address);
-
-  // 读取数据 4bytes
-  if (this->read_array((uint8_t *) &buffer, sizeof(buffer))) {
-    if (bl0910_checksum(address, &buffer) == buffer.checksum) {
-      // 根据是否有符号处理不同数据格式
-      if (signed_result) {
-        data_s24.l = buffer.l;
-        data_s24.m = buffer.m;
-        data_s24.h = buffer.h;
-      } else {
-        data_u24.l = buffer.l;
-        data_u24.m = buffer.m;
-        data_u24.h = buffer.h;
-      }
-    } else {
-      ESP_LOGW(TAG, "Checksum failed. Discarding message.");  // 如果校验和错误，丢弃数据
-      return;
-    }
+  float current_min = INFINITY, current_max = -INFINITY, current_sum = 0;
+  float power_min = INFINITY, power_max = -INFINITY, power_sum = 0;
+  for (uint16_t i = 1; i <= count; i++) {
+    const CaptureSample &sample =
+        this->capture_buffer_[(this->capture_head_ + BL0910_CAPTURE_BUFFER_SIZE - i) % BL0910_CAPTURE_BUFFER_SIZE];
+    current_min = std::min(current_min, sample.current);
+    current_max = std::max(current_max, sample.current);
+    current_sum += sample.current;
+    power_min = std::min(power_min, sample.power);
+    power_max = std::max(power_max, sample.power);
+    power_sum += sample.power;
   }
-  // 根据不同的参考值处理数据
-  if (reference == BL0910_PREF || reference == BL0910_WATT) {
-    value = (float) to_int32_t(data_s24) * reference;
+  ESP_LOGV(TAG, "Capture window: %u samples", count);
+  if (this->capture_current_min_sensor_ != nullptr) {
+    this->capture_current_min_sensor_->publish_state(current_min);
   }
-  if (reference == BL0910_UREF || reference == BL0910_IREF || reference == BL0910_EREF || reference == BL0910_CF) {
-    value = (float) to_uint32_t(data_u24) * reference;
+  if (this->capture_current_max_sensor_ != nullptr) {
+    this->capture_current_max_sensor_->publish_state(current_max);
   }
-  if (reference == BL0910_FREF) {
-    value = reference / (float) to_uint32_t(data_u24);
+  if (this->capture_current_mean_sensor_ != nullptr) {
+    this->capture_current_mean_sensor_->publish_state(current_sum / count);
   }
-  if (reference == BL0910_TREF) {
-    value = (float) to_int32_t(data_s24);
-    value = (value - 64) * 12.5 / 59 - 40;
+  if (this->capture_power_min_sensor_ != nullptr) {
+    this->capture_power_min_sensor_->publish_state(power_min);
+  }
+  if (this->capture_power_max_sensor_ != nullptr) {
+    this->capture_power_max_sensor_->publish_state(power_max);
+  }
+  if (this->capture_power_mean_sensor_ != nullptr) {
+    this->capture_power_mean_sensor_->publish_state(power_sum / count);
   }
-  sensor->publish_state(value);
 }
 
-// 计算功率因数 电流x电压x功率因数 = 有功功率
-void BL0910::calculate_power_factor_(sensor::Sensor *current_sensor, sensor::Sensor *voltage_sensor,
-                                     sensor::Sensor *power_sensor, sensor::Sensor *power_factor_sensor) {
-  if (current_sensor != nullptr && voltage_sensor != nullptr && power_sensor != nullptr &&
-      power_factor_sensor != nullptr) {
-    float power_factor = power_sensor->state / (current_sensor->state * voltage_sensor->state);
-    power_factor_sensor->publish_state(power_factor);
+// 合并写入：距离上次保存超过 energy_commit_interval_ 才写入 flash
+void BL0910::commit_energy_() {
+  if (!this->energy_dirty_ || millis() - this->last_energy_commit_ < this->energy_commit_interval_) {
+    return;
   }
+  this->energy_pref_.save(&this->energy_totals_);
+  this->last_energy_commit_ = millis();
+  this->energy_dirty_ = false;
 }
 
-// 偏移校准函数
-void BL0910::bias_correction_(uint8_t address, float measurements, float correction) {
-  DataPacket data;
+void BL0910::on_safe_shutdown() {
+  if (this->energy_dirty_) {
+    this->energy_pref_.save(&this->energy_totals_);
+    this->energy_dirty_ = false;
+  }
+}
+
+// 偏移校准值计算（measurements: 校准前测得的电流; correction: 实际电流）
+int32_t BL0910::bias_correction_(float measurements, float correction) {
   float i_rms0 = measurements * BL0910_KI;
   float i_rms = correction * BL0910_KI;
-  int32_t value = (i_rms * i_rms - i_rms0 * i_rms0) / 256;  // 计算校准值
-  // 将计算值写入数据包
-  data.l = (value >> 0) & 0xFF;
-  data.m = (value >> 8) & 0xFF;
-  data.h = (value >> 16) & 0xFF;
-  data.checksum = bl0910_checksum(address, &data);
-  ESP_LOGV(TAG, "RMSOS:%02X%02X%02X%02X%02X%02X", BL0910_WRITE_COMMAND, address, data.l, data.m, data.h, data.checksum);
-  this->flush();
-  this->write_byte(BL0910_WRITE_COMMAND);
-  this->write_byte(address);
-  this->write_array((uint8_t *) &data, sizeof(data));
-}
-
-// 增益校准函数
-void BL0910::gain_correction_(uint8_t address, float measurements, float correction) {
-  DataPacket data;
+  return (i_rms * i_rms - i_rms0 * i_rms0) / 256;
+}
+
+// 增益校准值计算（measurements: 校准前测得的电流; correction: 实际电流）
+int32_t BL0910::gain_correction_(float measurements, float correction) {
+  if (measurements == 0) {
+    return 0;
+  }
   float i_rms0 = measurements * BL0910_KI;
   float i_rms = correction * BL0910_KI;
-  int32_t value = int((i_rms / i_rms0 - 1) * 65536);  // 计算校准值
-  // 将计算值写入数据包
-  data.l = (value >> 0) & 0xFF;
-  data.m = (value >> 8) & 0xFF;
-  data.h = (value >> 16) & 0xFF;
-  data.checksum = bl0910_checksum(address, &data);
-  this->flush();
-  this->write_byte(BL0910_WRITE_COMMAND);
-  this->write_byte(address);
-  this->write_array((uint8_t *) &data, sizeof(data));
+  return int((i_rms / i_rms0 - 1) * 65536);
+}
+
+// 将需要写入的校准寄存器拼成一次连续发送，返回写入的寄存器数。
+// 写入总是紧跟在软复位之后，寄存器都处于默认值 0，因此不先回读，值为 0 的寄存器直接跳过
+size_t BL0910::write_calibration_() {
+  std::vector<uint8_t> burst;
+  auto append = [&burst](uint8_t address, int32_t value) {
+    if (value == 0) {
+      return;  // 与复位默认值相同，无需写入
+    }
+    DataPacket data;
+    data.l = (value >> 0) & 0xFF;
+    data.m = (value >> 8) & 0xFF;
+    data.h = (value >> 16) & 0xFF;
+    data.checksum = bl0910_checksum(address, &data);
+    ESP_LOGV(TAG, "Calibration:%02X%02X%02X%02X%02X%02X", BL0910_WRITE_COMMAND, address, data.l, data.m, data.h,
+             data.checksum);
+    burst.insert(burst.end(), {BL0910_WRITE_COMMAND, address, data.l, data.m, data.h, data.checksum});
+  };
+  for (const ChannelDescriptor &descriptor : this->channels_) {
+    append(descriptor.rmsos_address, descriptor.rmsos_value);
+    append(descriptor.rmsgn_address, descriptor.rmsgn_value);
+  }
+  if (burst.empty()) {
+    return 0;
+  }
+  this->write_array(burst);
+  return burst.size() / 6;
+}
+
+// 生成校准寄存器的回读项（每次写入校准后调用）。读取本身由 loop() 经流水线非阻塞地完成，
+// 校验期间暂停扫描与采集
+void BL0910::verify_calibration_() {
+  this->verify_entries_.clear();
+  this->verify_expected_.clear();
+  auto append = [this](uint8_t address, int32_t value) {
+    if (value == 0) {
+      return;
+    }
+    this->verify_entries_.push_back({address, CONVERTERS[REGISTER_KIND_UNSIGNED], 1.0f, nullptr, nullptr,
+                                     BL0910_NO_ENERGY_COUNTER, false});
+    this->verify_expected_.push_back((uint32_t) value & BL0910_CF_COUNT_MASK);
+  };
+  for (const ChannelDescriptor &descriptor : this->channels_) {
+    append(descriptor.rmsos_address, descriptor.rmsos_value);
+    append(descriptor.rmsgn_address, descriptor.rmsgn_value);
+  }
+  this->verify_index_ = 0;
+  this->verify_ok_ = 0;
+  this->verify_active_ = !this->verify_entries_.empty();
+}
+
+// 比对一个校准寄存器的回读值；超时或校验和错误的读取不会到达这里，最后按未确认计为失败
+void BL0910::check_calibration_(const ScheduleEntry &entry, const DataPacket &buffer) {
+  size_t index = &entry - this->verify_entries_.data();
+  if (index >= this->verify_entries_.size()) {
+    return;
+  }
+  if (to_uint32_t(buffer) != this->verify_expected_[index]) {
+    ESP_LOGW(TAG, "Calibration register 0x%02X verification failed.", entry.address);
+    return;
+  }
+  this->verify_ok_++;
+}
+
+void BL0910::finish_verification_() {
+  this->verify_active_ = false;
+  size_t total = this->verify_entries_.size();
+  if (this->verify_ok_ < total) {
+    ESP_LOGW(TAG, "%u of %u calibration registers failed verification.", (unsigned) (total - this->verify_ok_),
+             (unsigned) total);
+    this->status_set_warning();
+  } else {
+    ESP_LOGD(TAG, "%u calibration registers written and verified.", (unsigned) total);
+  }
+  // 回读项只在启动时使用
+  this->verify_entries_.clear();
+  this->verify_entries_.shrink_to_fit();
+  this->verify_expected_.clear();
+  this->verify_expected_.shrink_to_fit();
 }
 
 void BL0910::dump_config() {
   ESP_LOGCONFIG(TAG, "BL0910:");
+  ESP_LOGCONFIG(TAG, "  Pipeline depth: %u", this->pipeline_depth_);
+  ESP_LOGCONFIG(TAG, "  Registers per sweep: %u", (unsigned) this->schedule_.size());
+  if (this->capture_enabled_()) {
+    ESP_LOGCONFIG(TAG, "  Fast capture: channel %u, window %" PRIu32 " ms", this->capture_channel_ + 1,
+                  this->capture_window_);
+    LOG_SENSOR("    ", "Current min", this->capture_current_min_sensor_);
+    LOG_SENSOR("    ", "Current max", this->capture_current_max_sensor_);
+    LOG_SENSOR("    ", "Current mean", this->capture_current_mean_sensor_);
+    LOG_SENSOR("    ", "Power min", this->capture_power_min_sensor_);
+    LOG_SENSOR("    ", "Power max", this->capture_power_max_sensor_);
+    LOG_SENSOR("    ", "Power mean", this->capture_power_mean_sensor_);
+  }
+  ESP_LOGCONFIG(TAG, "  Energy commit interval: %" PRIu32 " ms", this->energy_commit_interval_);
   LOG_SENSOR("  ", "Voltage", this->voltage_sensor_);
 
-  LOG_SENSOR("  ", "Current1", this->current_1_sensor_);
-  LOG_SENSOR("  ", "Current2", this->current_2_sensor_);
-  LOG_SENSOR("  ", "Current3", this->current_3_sensor_);
-  LOG_SENSOR("  ", "Current4", this->current_4_sensor_);
-  LOG_SENSOR("  ", "Current5", this->current_5_sensor_);
-  LOG_SENSOR("  ", "Current6", this->current_6_sensor_);
-  LOG_SENSOR("  ", "Current7", this->current_7_sensor_);
-  LOG_SENSOR("  ", "Current8", this->current_8_sensor_);
-  LOG_SENSOR("  ", "Current9", this->current_9_sensor_);
-  LOG_SENSOR("  ", "Current10", this->current_10_sensor_);
-
-  LOG_SENSOR("  ", "Power1", this->power_1_sensor_);
-  LOG_SENSOR("  ", "Power2", this->power_2_sensor_);
-  LOG_SENSOR("  ", "Power3", this->power_3_sensor_);
-  LOG_SENSOR("  ", "Power4", this->power_4_sensor_);
-  LOG_SENSOR("  ", "Power5", this->power_5_sensor_);
-  LOG_SENSOR("  ", "Power6", this->power_6_sensor_);
-  LOG_SENSOR("  ", "Power7", this->power_7_sensor_);
-  LOG_SENSOR("  ", "Power8", this->power_8_sensor_);
-  LOG_SENSOR("  ", "Power9", this->power_9_sensor_);
-  LOG_SENSOR("  ", "Power10", this->power_10_sensor_);
-
-  LOG_SENSOR("  ", "Power factor 1", this->power_factor_1_sensor_);
-  LOG_SENSOR("  ", "Power factor 2", this->power_factor_2_sensor_);
-  LOG_SENSOR("  ", "Power factor 3", this->power_factor_3_sensor_);
-  LOG_SENSOR("  ", "Power factor 4", this->power_factor_4_sensor_);
-  LOG_SENSOR("  ", "Power factor 5", this->power_factor_5_sensor_);
-  LOG_SENSOR("  ", "Power factor 6", this->power_factor_6_sensor_);
-  LOG_SENSOR("  ", "Power factor 7", this->power_factor_7_sensor_);
-  LOG_SENSOR("  ", "Power factor 8", this->power_factor_8_sensor_);
-  LOG_SENSOR("  ", "Power factor 9", this->power_factor_9_sensor_);
-  LOG_SENSOR("  ", "Power factor 10", this->power_factor_10_sensor_);
-
-  LOG_SENSOR("  ", "Energy1", this->energy_1_sensor_);
-  LOG_SENSOR("  ", "Energy2", this->energy_2_sensor_);
-  LOG_SENSOR("  ", "Energy3", this->energy_3_sensor_);
-  LOG_SENSOR("  ", "Energy4", this->energy_4_sensor_);
-  LOG_SENSOR("  ", "Energy5", this->energy_5_sensor_);
-  LOG_SENSOR("  ", "Energy6", this->energy_6_sensor_);
-  LOG_SENSOR("  ", "Energy7", this->energy_7_sensor_);
-  LOG_SENSOR("  ", "Energy8", this->energy_8_sensor_);
-  LOG_SENSOR("  ", "Energy9", this->energy_9_sensor_);
-  LOG_SENSOR("  ", "Energy10", this->energy_10_sensor_);
+  for (uint8_t channel = 0; channel < BL0910_NUM_CHANNELS; channel++) {
+    const ChannelDescriptor &descriptor = this->channels_[channel];
+    if (descriptor.current_sensor == nullptr && descriptor.power_sensor == nullptr &&
+        descriptor.energy_sensor == nullptr && descriptor.power_factor_sensor == nullptr &&
+        descriptor.apparent_power_sensor == nullptr && descriptor.reactive_power_sensor == nullptr) {
+      continue;
+    }
+    ESP_LOGCONFIG(TAG, "  Channel %u:", channel + 1);
+    LOG_SENSOR("    ", "Current", descriptor.current_sensor);
+    LOG_SENSOR("    ", "Power", descriptor.power_sensor);
+    LOG_SENSOR("    ", "Power factor", descriptor.power_factor_sensor);
+    LOG_SENSOR("    ", "Apparent power", descriptor.apparent_power_sensor);
+    LOG_SENSOR("    ", "Reactive power", descriptor.reactive_power_sensor);
+    LOG_SENSOR("    ", "Energy", descriptor.energy_sensor);
+    if (descriptor.rmsos_value != 0 || descriptor.rmsgn_value != 0) {
+      ESP_LOGCONFIG(TAG, "    RMSOS: %" PRId32 ", RMSGN: %" PRId32, descriptor.rmsos_value, descriptor.rmsgn_value);
+    }
+  }
 
   LOG_SENSOR("  ", "Total Power", this->total_power_sensor_);
   LOG_SENSOR("  ", "Total Energy", this->total_energy_sensor_);
+  LOG_SENSOR("  ", "Total Apparent Power", this->total_apparent_power_sensor_);
+  LOG_SENSOR("  ", "Total Reactive Power", this->total_reactive_power_sensor_);
   LOG_SENSOR("  ", "Frequency", this->frequency_sensor_);
   LOG_SENSOR("  ", "Temperature", this->temperature_sensor_);
 }
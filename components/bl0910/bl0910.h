@@ -5,6 +5,12 @@
 #include "esphome/core/automation.h"
 #include "esphome/core/component.h"
 #include "esphome/core/datatypes.h"
+#include "esphome/core/preferences.h"
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <vector>
 
 namespace esphome {
 namespace bl0910 {
@@ -17,96 +23,296 @@ struct DataPacket {  // NOLINT(altera-struct-pack-align)
 //  uint8_t address;
 } __attribute__((packed));
 
-struct ube24_t {  // NOLINT(readability-identifier-naming,altera-struct-pack-align)
-  uint8_t l{0};
-  uint8_t m{0};
-  uint8_t h{0};
-} __attribute__((packed));
+// 寄存器数据类型，决定 24 位原始值的解释方式与换算公式
+enum RegisterKind : uint8_t {
+  REGISTER_KIND_UNSIGNED = 0,  // 无符号：有效值、脉冲计数，值 = 原始值 x 系数
+  REGISTER_KIND_SIGNED,        // 有符号：有功功率，值 = 原始值 x 系数
+  REGISTER_KIND_TEMPERATURE,   // 内部温度，值 = (原始值 - 64) x 系数 - 40
+  REGISTER_KIND_PERIOD,        // 周期：频率，值 = 系数 / 原始值
+};
 
-struct sbe24_t {  // NOLINT(readability-identifier-naming,altera-struct-pack-align)
-  uint8_t l{0};
-  uint8_t m{0};
-  int8_t h{0};
-} __attribute__((packed));
+// 按寄存器类型特化的换算函数，在生成调度表时选定
+using ConvertFunc = float (*)(const DataPacket &data, float scale);
+
+// 流水线模式下最多同时在途的读取命令数
+static const uint8_t BL0910_MAX_PIPELINE_DEPTH = 8;
+// 9600 波特率下 4 字节响应约 4.2ms，超过该时间没有收到任何响应则放弃最早的读取
+static const uint32_t BL0910_READ_TIMEOUT_MS = 20;
 
 template<typename... Ts> class ResetEnergyAction;
 
 class BL0910;
 
-using ActionCallbackFuncPtr = void (BL0910::*)();
+// 通道数量
+static const uint8_t BL0910_NUM_CHANNELS = 10;
+// 电量累加器数量：10 个通道加上合计
+static const uint8_t BL0910_NUM_ENERGY_COUNTERS = BL0910_NUM_CHANNELS + 1;
+// 合计电量在累加器中的下标
+static const uint8_t BL0910_TOTAL_ENERGY_COUNTER = BL0910_NUM_CHANNELS;
+// 调度表项不对应电量累加器
+static const uint8_t BL0910_NO_ENERGY_COUNTER = UINT8_MAX;
+// CF 脉冲计数寄存器为 24 位
+static const uint32_t BL0910_CF_COUNT_MASK = 0xFFFFFF;
+
+// 快速采集环形缓冲区容量（样本数）
+static const uint16_t BL0910_CAPTURE_BUFFER_SIZE = 128;
+
+// 快速采集的一个样本：同一通道相邻两次读取的电流与功率
+struct CaptureSample {
+  uint32_t timestamp;
+  float current;
+  float power;
+};
+
+// 持久化保存的累计脉冲数，计数寄存器回绕或芯片复位后电量仍单调递增
+struct EnergyTotals {
+  uint64_t pulses[BL0910_NUM_ENERGY_COUNTERS];
+};
+
+// 单个通道的描述：寄存器地址、换算系数以及对应的传感器
+struct ChannelDescriptor {
+  uint8_t current_address;
+  uint8_t power_address;
+  uint8_t energy_address;
+  uint8_t rmsgn_address;
+  uint8_t rmsos_address;
+  float current_scale;
+  float power_scale;
+  float energy_scale;
+  sensor::Sensor *current_sensor{nullptr};
+  sensor::Sensor *power_sensor{nullptr};
+  sensor::Sensor *energy_sensor{nullptr};
+  sensor::Sensor *power_factor_sensor{nullptr};
+  sensor::Sensor *apparent_power_sensor{nullptr};
+  sensor::Sensor *reactive_power_sensor{nullptr};
+  // 有效值偏置、增益校准寄存器的目标值（复位默认值为 0）
+  int32_t rmsos_value{0};
+  int32_t rmsgn_value{0};
+};
+
+// 扫描调度表的一项：寄存器地址、换算函数与系数、对应的传感器、派生量快照位置以及电量累加器下标
+struct ScheduleEntry {
+  uint8_t address;
+  ConvertFunc convert;
+  float scale;
+  sensor::Sensor *sensor;  // 为 nullptr 时只读取用于派生量计算，不发布
+  float *snapshot;         // 本轮扫描快照中保存该读数的位置，可为 nullptr
+  uint8_t energy_counter;
+  bool capture;  // 快速采集读取项，结果写入环形缓冲区
+};
+
+// 一轮扫描中单个通道的读数快照，用于计算视在功率、无功功率与功率因数
+struct ChannelSnapshot {
+  float current{NAN};
+  float power{NAN};
+};
+
+using ActionCallbackFuncPtr = void (BL0910::*)(uint8_t argument);
+
+// 排队等待执行的动作及其参数
+struct QueuedAction {
+  ActionCallbackFuncPtr function;
+  uint8_t argument;
+};
+
+// 动作队列容量
+static const uint8_t BL0910_ACTION_QUEUE_SIZE = 8;
+// reset_energy 的通道参数：所有通道
+static const uint8_t BL0910_ALL_CHANNELS = UINT8_MAX;
+
+// 单生产者/单消费者的固定容量环形队列，入队与出队都不分配内存。
+// 实际容量为 N - 1，留出一格用于区分队满与队空。
+template<typename T, uint8_t N> class SPSCQueue {
+ public:
+  bool push(const T &item) {
+    uint8_t head = this->head_.load(std::memory_order_relaxed);
+    uint8_t next = (head + 1) % N;
+    if (next == this->tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    this->items_[head] = item;
+    this->head_.store(next, std::memory_order_release);
+    return true;
+  }
+  bool pop(T &item) {
+    uint8_t tail = this->tail_.load(std::memory_order_relaxed);
+    if (tail == this->head_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    item = this->items_[tail];
+    this->tail_.store((tail + 1) % N, std::memory_order_release);
+    return true;
+  }
+  bool empty() const {
+    return this->tail_.load(std::memory_order_acquire) == this->head_.load(std::memory_order_acquire);
+  }
+
+ protected:
+  std::array<T, N> items_{};
+  std::atomic<uint8_t> head_{0};
+  std::atomic<uint8_t> tail_{0};
+};
 
 class BL0910 : public PollingComponent, public uart::UARTDevice {
   SUB_SENSOR(voltage)
-  SUB_SENSOR(current_1)
-  SUB_SENSOR(current_2)
-  SUB_SENSOR(current_3)
-  SUB_SENSOR(current_4)
-  SUB_SENSOR(current_5)
-  SUB_SENSOR(current_6)
-  SUB_SENSOR(current_7)
-  SUB_SENSOR(current_8)
-  SUB_SENSOR(current_9)
-  SUB_SENSOR(current_10)
-  SUB_SENSOR(power_1)
-  SUB_SENSOR(power_2)
-  SUB_SENSOR(power_3)
-  SUB_SENSOR(power_4)
-  SUB_SENSOR(power_5)
-  SUB_SENSOR(power_6)
-  SUB_SENSOR(power_7)
-  SUB_SENSOR(power_8)
-  SUB_SENSOR(power_9)
-  SUB_SENSOR(power_10)
   SUB_SENSOR(total_power)
-  SUB_SENSOR(power_factor_1)
-  SUB_SENSOR(power_factor_2)
-  SUB_SENSOR(power_factor_3)
-  SUB_SENSOR(power_factor_4)
-  SUB_SENSOR(power_factor_5)
-  SUB_SENSOR(power_factor_6)
-  SUB_SENSOR(power_factor_7)
-  SUB_SENSOR(power_factor_8)
-  SUB_SENSOR(power_factor_9)
-  SUB_SENSOR(power_factor_10)
-  SUB_SENSOR(energy_1)
-  SUB_SENSOR(energy_2)
-  SUB_SENSOR(energy_3)
-  SUB_SENSOR(energy_4)
-  SUB_SENSOR(energy_5)
-  SUB_SENSOR(energy_6)
-  SUB_SENSOR(energy_7)
-  SUB_SENSOR(energy_8)
-  SUB_SENSOR(energy_9)
-  SUB_SENSOR(energy_10)
   SUB_SENSOR(total_energy)
+  SUB_SENSOR(total_apparent_power)
+  SUB_SENSOR(total_reactive_power)
   SUB_SENSOR(frequency)
   SUB_SENSOR(temperature)
+  SUB_SENSOR(capture_current_min)
+  SUB_SENSOR(capture_current_max)
+  SUB_SENSOR(capture_current_mean)
+  SUB_SENSOR(capture_power_min)
+  SUB_SENSOR(capture_power_max)
+  SUB_SENSOR(capture_power_mean)
 
  public:
   void loop() override;
   void update() override;
   void setup() override;
   void dump_config() override;
+  void on_safe_shutdown() override;
+
+  BL0910();
+
+  void set_pipeline_depth(uint8_t pipeline_depth) { this->pipeline_depth_ = pipeline_depth; }
+  void set_offset_calibration(uint8_t channel, float measured, float actual) {
+    this->channels_[channel].rmsos_value = bias_correction_(measured, actual);
+  }
+  void set_gain_calibration(uint8_t channel, float measured, float actual) {
+    this->channels_[channel].rmsgn_value = gain_correction_(measured, actual);
+  }
+  void set_capture_channel(uint8_t channel) { this->capture_channel_ = channel; }
+  void set_capture_window(uint32_t capture_window) { this->capture_window_ = capture_window; }
+  // 快速采集的最近样本（环形缓冲区），可在 lambda 中读取
+  const std::array<CaptureSample, BL0910_CAPTURE_BUFFER_SIZE> &get_capture_buffer() const {
+    return this->capture_buffer_;
+  }
+  uint16_t get_capture_head() const { return this->capture_head_; }
+  void set_energy_preference_key(const std::string &key) { this->energy_preference_key_ = key; }
+  void set_energy_commit_interval(uint32_t energy_commit_interval) {
+    this->energy_commit_interval_ = energy_commit_interval;
+  }
+  void set_current_sensor(uint8_t channel, sensor::Sensor *sensor) { this->channels_[channel].current_sensor = sensor; }
+  void set_power_sensor(uint8_t channel, sensor::Sensor *sensor) { this->channels_[channel].power_sensor = sensor; }
+  void set_energy_sensor(uint8_t channel, sensor::Sensor *sensor) { this->channels_[channel].energy_sensor = sensor; }
+  void set_power_factor_sensor(uint8_t channel, sensor::Sensor *sensor) {
+    this->channels_[channel].power_factor_sensor = sensor;
+  }
+  void set_apparent_power_sensor(uint8_t channel, sensor::Sensor *sensor) {
+    this->channels_[channel].apparent_power_sensor = sensor;
+  }
+  void set_reactive_power_sensor(uint8_t channel, sensor::Sensor *sensor) {
+    this->channels_[channel].reactive_power_sensor = sensor;
+  }
+  void set_power_deadband(float power_deadband) { this->power_deadband_ = power_deadband; }
+  void set_power_factor_deadband(float power_factor_deadband) {
+    this->power_factor_deadband_ = power_factor_deadband;
+  }
 
  protected:
   template<typename... Ts> friend class ResetEnergyAction;
-  void reset_energy_();
-  void read_data_(uint8_t address, float reference, sensor::Sensor *sensor);
-  void calculate_power_factor_(sensor::Sensor *current_sensor, sensor::Sensor *voltage_sensor,
-                               sensor::Sensor *power_sensor, sensor::Sensor *power_factor_sensor);
-  void bias_correction_(uint8_t address, float measurements, float correction);
-  void gain_correction_(uint8_t address, float measurements, float correction);
-  uint8_t current_channel_{0};
-  size_t enqueue_action_(ActionCallbackFuncPtr function);
+  void reset_energy_(uint8_t channel);
+  void send_requests_();
+  void receive_responses_();
+  void drop_in_flight_(uint8_t count);
+  void send_request_(const ScheduleEntry *entry);
+  const ScheduleEntry &in_flight_entry_(uint8_t offset) const {
+    return *this->in_flight_[(this->in_flight_head_ + offset) % BL0910_MAX_PIPELINE_DEPTH];
+  }
+  void publish_data_(const ScheduleEntry &entry, const DataPacket &buffer);
+  void finish_sweep_();
+  void drain_rx_();
+  bool has_derived_sensors_(const ChannelDescriptor &descriptor) const;
+  void compute_derived_metrics_();
+  void publish_with_deadband_(sensor::Sensor *sensor, float value, float deadband);
+  static int32_t bias_correction_(float measurements, float correction);
+  static int32_t gain_correction_(float measurements, float correction);
+  size_t write_calibration_();
+  void verify_calibration_();
+  void check_calibration_(const ScheduleEntry &entry, const DataPacket &buffer);
+  void finish_verification_();
+  // 各通道的寄存器、换算系数与传感器，连续存放
+  std::array<ChannelDescriptor, BL0910_NUM_CHANNELS> channels_;
+  // setup() 中根据已配置的传感器预先计算：每轮扫描读取的寄存器、需要计算派生量的通道
+  std::vector<ScheduleEntry> schedule_{};
+  std::vector<uint8_t> active_channels_{};
+  // 本轮扫描的电压、各通道电流与功率读数，扫描结束后一次性计算派生量
+  float voltage_snapshot_{NAN};
+  std::array<ChannelSnapshot, BL0910_NUM_CHANNELS> snapshot_{};
+  // 校准回读：setup() 中生成读取项，由 loop() 经流水线发送，响应在正常接收路径中比对
+  std::vector<ScheduleEntry> verify_entries_{};
+  std::vector<uint32_t> verify_expected_{};
+  size_t verify_index_{0};
+  size_t verify_ok_{0};
+  bool verify_active_{false};
+  // 新一轮扫描开始时仍在途的上一轮命令数，它们的响应不写入本轮快照
+  uint8_t stale_in_flight_{0};
+  float power_deadband_{0};
+  float power_factor_deadband_{0};
+  void build_schedule_();
+  void add_schedule_entry_(uint8_t address, RegisterKind kind, float scale, sensor::Sensor *sensor,
+                           float *snapshot = nullptr, uint8_t energy_counter = BL0910_NO_ENERGY_COUNTER);
+  // 下一个待发送的 schedule_ 项，等于其长度时表示本轮扫描的命令已全部发出
+  size_t schedule_index_{0};
+  bool sweep_active_{false};
+  // 已发送、按发送顺序等待响应的读取命令（环形队列）
+  std::array<const ScheduleEntry *, BL0910_MAX_PIPELINE_DEPTH> in_flight_{};
+  uint8_t in_flight_head_{0};
+  uint8_t in_flight_count_{0};
+  uint8_t pipeline_depth_{1};
+  // 最近一次发送命令或收到响应的时间，用于超时判断
+  uint32_t last_activity_{0};
+  // 快速采集：扫描空闲时连续读取选定通道的电流与功率，按窗口发布统计值
+  void build_capture_entries_();
+  void store_capture_sample_(const ScheduleEntry &entry, float value);
+  void publish_capture_window_();
+  bool capture_enabled_() const { return this->capture_channel_ < BL0910_NUM_CHANNELS; }
+  uint8_t capture_channel_{UINT8_MAX};
+  uint32_t capture_window_{1000};
+  uint32_t capture_window_start_{0};
+  // 采集用的电流、功率读取项（sensor 为 nullptr，结果写入环形缓冲区）
+  std::array<ScheduleEntry, 2> capture_entries_{};
+  uint8_t capture_next_{0};
+  float capture_current_{NAN};
+  std::array<CaptureSample, BL0910_CAPTURE_BUFFER_SIZE> capture_buffer_{};
+  uint16_t capture_head_{0};
+  // 当前窗口内写入的样本数
+  uint16_t capture_window_count_{0};
+  // 电量累加：上一次读到的 24 位硬件计数与持久化的 64 位累计值
+  uint64_t accumulate_energy_(uint8_t counter, uint32_t count);
+  void commit_energy_();
+  std::array<uint32_t, BL0910_NUM_ENERGY_COUNTERS> cf_counts_{};
+  EnergyTotals energy_totals_{};
+  ESPPreferenceObject energy_pref_;
+  std::string energy_preference_key_{"bl0910"};
+  uint32_t energy_commit_interval_{300000};
+  uint32_t last_energy_commit_{0};
+  bool energy_dirty_{false};
+  bool enqueue_action_(ActionCallbackFuncPtr function, uint8_t argument);
+  bool enqueue_channel_reset_(uint8_t channel);
   void handle_actions_();
+  void soft_reset_(uint8_t argument);
+  void restore_calibration_(uint8_t argument);
 
  private:
-  std::vector<ActionCallbackFuncPtr> action_queue_{};
+  SPSCQueue<QueuedAction, BL0910_ACTION_QUEUE_SIZE> action_queue_{};
 };
 
 template<typename... Ts> class ResetEnergyAction : public Action<Ts...>, public Parented<BL0910> {
  public:
-  void play(Ts... x) override { this->parent_->enqueue_action_(&BL0910::reset_energy_); }
+  TEMPLATABLE_VALUE(uint8_t, channel)
+
+  // channel 未设置时重置所有通道，否则只清零该通道（从 1 开始）的累计电量
+  void play(Ts... x) override {
+    if (!this->channel_.has_value()) {
+      this->parent_->enqueue_action_(&BL0910::reset_energy_, BL0910_ALL_CHANNELS);
+      return;
+    }
+    this->parent_->enqueue_channel_reset_(this->channel_.value(x...));
+  }
 };
 
 }  // namespace bl0910
@@ -13,7 +13,7 @@ static const float BL0910_CF = 16 * BL0910_EREF;
 static const float BL0910_FREF = 10000000;                                                             // Frequency
 static const float BL0910_KI = 12875 * 5.1 / 1.097;            // Current coefficient
 static const float BL0910_KP = 40.4125 * 5.1 / 1.097 / 1.097;  // Power coefficient
-static const float BL0910_TREF = 12.5 / 59 - 40;               // Temperature
+static const float BL0910_TREF = 12.5 / 59;                    // Temperature, per LSB above 64
 
 // Register address
 // Voltage
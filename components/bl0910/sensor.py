@@ -4,7 +4,7 @@ import esphome.codegen as cg
 from esphome.components import sensor, uart
 import esphome.config_validation as cv
 from esphome.const import (
-    CONF_CHANNEL, CONF_CURRENT, CONF_ENERGY, CONF_FREQUENCY, CONF_ID, CONF_NAME, CONF_POWER, CONF_TEMPERATURE, CONF_TOTAL_POWER, CONF_VOLTAGE, CONF_POWER_FACTOR, DEVICE_CLASS_CURRENT, DEVICE_CLASS_ENERGY, DEVICE_CLASS_FREQUENCY, DEVICE_CLASS_POWER, DEVICE_CLASS_TEMPERATURE, DEVICE_CLASS_VOLTAGE, DEVICE_CLASS_POWER_FACTOR, ICON_CURRENT_AC, ICON_THERMOMETER, STATE_CLASS_MEASUREMENT, STATE_CLASS_TOTAL_INCREASING, UNIT_AMPERE, UNIT_CELSIUS, UNIT_HERTZ, UNIT_KILOWATT_HOURS, UNIT_VOLT, UNIT_WATT,
+    CONF_CHANNEL, CONF_CURRENT, CONF_ENERGY, CONF_FREQUENCY, CONF_ID, CONF_NAME, CONF_POWER, CONF_TEMPERATURE, CONF_TOTAL_POWER, CONF_VOLTAGE, CONF_POWER_FACTOR, DEVICE_CLASS_CURRENT, DEVICE_CLASS_ENERGY, DEVICE_CLASS_FREQUENCY, DEVICE_CLASS_POWER, DEVICE_CLASS_TEMPERATURE, DEVICE_CLASS_VOLTAGE, DEVICE_CLASS_POWER_FACTOR, DEVICE_CLASS_APPARENT_POWER, DEVICE_CLASS_REACTIVE_POWER, ICON_CURRENT_AC, ICON_THERMOMETER, STATE_CLASS_MEASUREMENT, STATE_CLASS_TOTAL_INCREASING, UNIT_AMPERE, UNIT_CELSIUS, UNIT_HERTZ, UNIT_KILOWATT_HOURS, UNIT_VOLT, UNIT_WATT,
 )
 
 # 自定义图标
@@ -13,12 +13,36 @@ ICON_ENERGY = "mdi:lightning-bolt"
 ICON_FREQUENCY = "mdi:metronome"
 ICON_VOLTAGE = "mdi:sine-wave"
 ICON_POWER_FACTOR = "mdi:angle-acute"
+ICON_APPARENT_POWER = "mdi:flash-outline"
+UNIT_VOLT_AMPS = "VA"
+UNIT_VOLT_AMPS_REACTIVE = "var"
 
 # 组件依赖于UART模块，AUTO_LOAD将加载BL0910模块
 DEPENDENCIES = ["uart"]
 AUTO_LOAD = ["bl0910"]
 CODEOWNERS = ["@synodriver", "@MiaoJiawei"]
 CONF_TOTAL_ENERGY = "total_energy"
+CONF_PIPELINE_DEPTH = "pipeline_depth"
+CONF_ENERGY_COMMIT_INTERVAL = "energy_commit_interval"
+CONF_APPARENT_POWER = "apparent_power"
+CONF_REACTIVE_POWER = "reactive_power"
+CONF_TOTAL_APPARENT_POWER = "total_apparent_power"
+CONF_TOTAL_REACTIVE_POWER = "total_reactive_power"
+CONF_POWER_DEADBAND = "power_deadband"
+CONF_POWER_FACTOR_DEADBAND = "power_factor_deadband"
+CONF_CALIBRATION = "calibration"
+CONF_OFFSET = "offset"
+CONF_GAIN = "gain"
+CONF_MEASURED = "measured"
+CONF_ACTUAL = "actual"
+CONF_FAST_CAPTURE = "fast_capture"
+CONF_WINDOW = "window"
+CONF_CURRENT_MIN = "current_min"
+CONF_CURRENT_MAX = "current_max"
+CONF_CURRENT_MEAN = "current_mean"
+CONF_POWER_MIN = "power_min"
+CONF_POWER_MAX = "power_max"
+CONF_POWER_MEAN = "power_mean"
 
 # 定义命名空间和类
 bl0910_ns = cg.esphome_ns.namespace("bl0910")
@@ -35,6 +59,14 @@ def create_sensor_schema(icon, accuracy_decimals, device_class, unit, state_clas
         state_class=state_class,
     )
 
+# 校准点：校准前测得的电流与实际电流（安培）
+CALIBRATION_POINT_SCHEMA = cv.Schema(
+    {
+        cv.Required(CONF_MEASURED): cv.float_,
+        cv.Required(CONF_ACTUAL): cv.float_,
+    }
+)
+
 # 配置模式（CONFIG_SCHEMA），用于定义BL0910传感器的各项参数
 CONFIG_SCHEMA = (
     cv.Schema(
@@ -45,6 +77,28 @@ CONFIG_SCHEMA = (
             cv.Optional(CONF_VOLTAGE): create_sensor_schema(ICON_VOLTAGE, 1, DEVICE_CLASS_VOLTAGE, UNIT_VOLT, STATE_CLASS_MEASUREMENT),
             cv.Optional(CONF_TOTAL_POWER): create_sensor_schema(ICON_POWER, 3, DEVICE_CLASS_POWER, UNIT_WATT, STATE_CLASS_MEASUREMENT),
             cv.Optional(CONF_TOTAL_ENERGY): create_sensor_schema(ICON_ENERGY, 3, DEVICE_CLASS_ENERGY, UNIT_KILOWATT_HOURS, STATE_CLASS_TOTAL_INCREASING),
+            cv.Optional(CONF_TOTAL_APPARENT_POWER): create_sensor_schema(ICON_APPARENT_POWER, 3, DEVICE_CLASS_APPARENT_POWER, UNIT_VOLT_AMPS, STATE_CLASS_MEASUREMENT),
+            cv.Optional(CONF_TOTAL_REACTIVE_POWER): create_sensor_schema(ICON_APPARENT_POWER, 3, DEVICE_CLASS_REACTIVE_POWER, UNIT_VOLT_AMPS_REACTIVE, STATE_CLASS_MEASUREMENT),
+            # 派生量（视在功率、无功功率、功率因数）与上次发布值的差不超过死区时不发布，0 表示每轮都发布
+            cv.Optional(CONF_POWER_DEADBAND, default=0): cv.positive_float,
+            cv.Optional(CONF_POWER_FACTOR_DEADBAND, default=0): cv.positive_float,
+            # 同时在途的读取命令数，1 为逐条问答，大于 1 时连续发送多条读取命令
+            cv.Optional(CONF_PIPELINE_DEPTH, default=1): cv.int_range(min=1, max=8),
+            # 累计电量写入 flash 的最小间隔，用于限制 flash 磨损
+            cv.Optional(CONF_ENERGY_COMMIT_INTERVAL, default="5min"): cv.positive_time_period_milliseconds,
+            # 快速采集：扫描空闲时连续读取一个通道的电流与功率，按窗口发布最小/最大/平均值
+            cv.Optional(CONF_FAST_CAPTURE): cv.Schema(
+                {
+                    cv.Required(CONF_CHANNEL): cv.int_range(min=1, max=10),
+                    cv.Optional(CONF_WINDOW, default="1s"): cv.positive_time_period_milliseconds,
+                    cv.Optional(CONF_CURRENT_MIN): create_sensor_schema(ICON_CURRENT_AC, 3, DEVICE_CLASS_CURRENT, UNIT_AMPERE, STATE_CLASS_MEASUREMENT),
+                    cv.Optional(CONF_CURRENT_MAX): create_sensor_schema(ICON_CURRENT_AC, 3, DEVICE_CLASS_CURRENT, UNIT_AMPERE, STATE_CLASS_MEASUREMENT),
+                    cv.Optional(CONF_CURRENT_MEAN): create_sensor_schema(ICON_CURRENT_AC, 3, DEVICE_CLASS_CURRENT, UNIT_AMPERE, STATE_CLASS_MEASUREMENT),
+                    cv.Optional(CONF_POWER_MIN): create_sensor_schema(ICON_POWER, 3, DEVICE_CLASS_POWER, UNIT_WATT, STATE_CLASS_MEASUREMENT),
+                    cv.Optional(CONF_POWER_MAX): create_sensor_schema(ICON_POWER, 3, DEVICE_CLASS_POWER, UNIT_WATT, STATE_CLASS_MEASUREMENT),
+                    cv.Optional(CONF_POWER_MEAN): create_sensor_schema(ICON_POWER, 3, DEVICE_CLASS_POWER, UNIT_WATT, STATE_CLASS_MEASUREMENT),
+                }
+            ),
         }
     )
     # 为每个通道创建一个Schema，每个通道可以包含电流、功率和能量传感器
@@ -69,6 +123,23 @@ CONFIG_SCHEMA = (
                             create_sensor_schema(ICON_POWER_FACTOR, 3, DEVICE_CLASS_POWER_FACTOR, "", STATE_CLASS_MEASUREMENT),
                             key=CONF_NAME,
                         ),
+                        cv.Optional(CONF_APPARENT_POWER): cv.maybe_simple_value(
+                            create_sensor_schema(ICON_APPARENT_POWER, 3, DEVICE_CLASS_APPARENT_POWER, UNIT_VOLT_AMPS, STATE_CLASS_MEASUREMENT),
+                            key=CONF_NAME,
+                        ),
+                        cv.Optional(CONF_REACTIVE_POWER): cv.maybe_simple_value(
+                            create_sensor_schema(ICON_APPARENT_POWER, 3, DEVICE_CLASS_REACTIVE_POWER, UNIT_VOLT_AMPS_REACTIVE, STATE_CLASS_MEASUREMENT),
+                            key=CONF_NAME,
+                        ),
+                        # 电流有效值校准：offset 写入 RMSOS（空载偏置），gain 写入 RMSGN（增益）
+                        # 启动和 reset_energy 时先软复位再写入，复位后寄存器均为 0，
+                        # 所以不回读比较，只跳过换算结果为 0 的寄存器；写入后逐个回读校验
+                        cv.Optional(CONF_CALIBRATION): cv.Schema(
+                            {
+                                cv.Optional(CONF_OFFSET): CALIBRATION_POINT_SCHEMA,
+                                cv.Optional(CONF_GAIN): CALIBRATION_POINT_SCHEMA,
+                            }
+                        ),
                     }
                 )
                 for i in range(10) # 创建10个通道配置
@@ -92,12 +163,17 @@ FINAL_VALIDATE_SCHEMA = uart.final_validate_device_schema(
     maybe_simple_id(
         {
             cv.Required(CONF_ID): cv.use_id(BL0910),
+            # 指定通道时只清零该通道的累计电量，否则复位芯片并清零所有电量
+            cv.Optional(CONF_CHANNEL): cv.templatable(cv.int_range(min=1, max=10)),
         }
     ),
 )
 async def reset_energy_to_code(config, action_id, template_arg, args):
     var = cg.new_Pvariable(action_id, template_arg)
     await cg.register_parented(var, config[CONF_ID])
+    if CONF_CHANNEL in config:
+        channel = await cg.templatable(config[CONF_CHANNEL], args, cg.uint8)
+        cg.add(var.set_channel(channel))
     return var
 
 # 辅助函数，用于创建和注册传感器
@@ -106,11 +182,20 @@ async def register_sensor(var, config, sensor_name, sensor_fn):
         sens = await sensor.new_sensor(sensor_config)
         cg.add(sensor_fn(sens))
 
+# 辅助函数，用于创建和注册通道传感器（channel 从 0 开始）
+async def register_channel_sensor(var, config, sensor_name, channel, sensor_fn):
+    if sensor_config := config.get(sensor_name):
+        sens = await sensor.new_sensor(sensor_config)
+        cg.add(sensor_fn(channel, sens))
+
 # 主函数：根据配置生成代码
 async def to_code(config):
     var = cg.new_Pvariable(config[CONF_ID])
     await cg.register_component(var, config)
     await uart.register_uart_device(var, config)
+    cg.add(var.set_pipeline_depth(config[CONF_PIPELINE_DEPTH]))
+    cg.add(var.set_energy_preference_key(str(config[CONF_ID])))
+    cg.add(var.set_energy_commit_interval(config[CONF_ENERGY_COMMIT_INTERVAL]))
 
     # 注册传感器：频率、温度、电压、总功率、总能量
     await register_sensor(var, config, CONF_FREQUENCY, var.set_frequency_sensor)
@@ -118,11 +203,33 @@ async def to_code(config):
     await register_sensor(var, config, CONF_VOLTAGE, var.set_voltage_sensor)
     await register_sensor(var, config, CONF_TOTAL_POWER, var.set_total_power_sensor)
     await register_sensor(var, config, CONF_TOTAL_ENERGY, var.set_total_energy_sensor)
+    await register_sensor(var, config, CONF_TOTAL_APPARENT_POWER, var.set_total_apparent_power_sensor)
+    await register_sensor(var, config, CONF_TOTAL_REACTIVE_POWER, var.set_total_reactive_power_sensor)
+    cg.add(var.set_power_deadband(config[CONF_POWER_DEADBAND]))
+    cg.add(var.set_power_factor_deadband(config[CONF_POWER_FACTOR_DEADBAND]))
 
     # 遍历10个通道，注册各自的电流、功率、电量及功率因数传感器
     for i in range(10):
         if channel_config := config.get(f"{CONF_CHANNEL}_{i + 1}"):
-            await register_sensor(var, channel_config, CONF_CURRENT, getattr(var, f"set_current_{i + 1}_sensor"))
-            await register_sensor(var, channel_config, CONF_POWER, getattr(var, f"set_power_{i + 1}_sensor"))
-            await register_sensor(var, channel_config, CONF_ENERGY, getattr(var, f"set_energy_{i + 1}_sensor"))
-            await register_sensor(var, channel_config, CONF_POWER_FACTOR, getattr(var, f"set_power_factor_{i + 1}_sensor"))
+            await register_channel_sensor(var, channel_config, CONF_CURRENT, i, var.set_current_sensor)
+            await register_channel_sensor(var, channel_config, CONF_POWER, i, var.set_power_sensor)
+            await register_channel_sensor(var, channel_config, CONF_ENERGY, i, var.set_energy_sensor)
+            await register_channel_sensor(var, channel_config, CONF_POWER_FACTOR, i, var.set_power_factor_sensor)
+            await register_channel_sensor(var, channel_config, CONF_APPARENT_POWER, i, var.set_apparent_power_sensor)
+            await register_channel_sensor(var, channel_config, CONF_REACTIVE_POWER, i, var.set_reactive_power_sensor)
+            calibration = channel_config.get(CONF_CALIBRATION, {})
+            if offset := calibration.get(CONF_OFFSET):
+                cg.add(var.set_offset_calibration(i, offset[CONF_MEASURED], offset[CONF_ACTUAL]))
+            if gain := calibration.get(CONF_GAIN):
+                cg.add(var.set_gain_calibration(i, gain[CONF_MEASURED], gain[CONF_ACTUAL]))
+
+    # 快速采集
+    if capture_config := config.get(CONF_FAST_CAPTURE):
+        cg.add(var.set_capture_channel(capture_config[CONF_CHANNEL] - 1))
+        cg.add(var.set_capture_window(capture_config[CONF_WINDOW]))
+        await register_sensor(var, capture_config, CONF_CURRENT_MIN, var.set_capture_current_min_sensor)
+        await register_sensor(var, capture_config, CONF_CURRENT_MAX, var.set_capture_current_max_sensor)
+        await register_sensor(var, capture_config, CONF_CURRENT_MEAN, var.set_capture_current_mean_sensor)
+        await register_sensor(var, capture_config, CONF_POWER_MIN, var.set_capture_power_min_sensor)
+        await register_sensor(var, capture_config, CONF_POWER_MAX, var.set_capture_power_max_sensor)
+        await register_sensor(var, capture_config, CONF_POWER_MEAN, var.set_capture_power_mean_sensor)
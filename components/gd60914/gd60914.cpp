@@ -6,23 +6,30 @@ namespace gd60914 {
 
 static const char *const TAG = "gd60914";
 
+// 应答为7个ASCII字符的温度值，无帧头和校验
+static const uart_transaction::FrameDescriptor TEMPERATURE_RESPONSE = {{0x00, 0x00}, 0, 7, uart_transaction::CHECKSUM_NONE, 0};
+
 void GD60914Component::setup() {
   ESP_LOGW(TAG, "setup gd60914 sensor");
-  this->write_byte(SINGLE); //  打开单次测量功能，只需发一次
+  this->transaction_.send(&SINGLE, 1, nullptr, nullptr); //  打开单次测量功能，只需发一次
 }
 
 void GD60914Component::update() {
-  while (this->available()) {
-    this->read();
-  }
-  this->write_byte(this->mode_);
-  uint8_t buffer[8];
-  buffer[7] = 0;
-  this->read_array(buffer, 7);
-  int temperature = atoi((const char*)buffer);
-  if (this->temperature_sensor_ != nullptr) {
-    this->temperature_sensor_->publish_state((float)temperature / 10.0f); // 温度传感器精度为0.1度
-  }
+  uint8_t mode = this->mode_;
+  this->transaction_.send(&mode, 1, &TEMPERATURE_RESPONSE,
+                          [this](uart_transaction::TransactionStatus status, const uint8_t *data, uint8_t len) {
+    if (status != uart_transaction::TRANSACTION_OK) {
+      ESP_LOGW(TAG, "gd60914 read timeout, got %u bytes", len);
+      this->status_set_warning();
+      return;
+    }
+    std::string str(reinterpret_cast<const char *>(data), 7);
+    int temperature = atoi(str.c_str());
+    if (this->temperature_sensor_ != nullptr) {
+      this->temperature_sensor_->publish_state((float)temperature / 10.0f); // 温度传感器精度为0.1度
+    }
+    this->status_clear_warning();
+  });
 }
 
 void GD60914Component::dump_config() {
@@ -32,24 +39,15 @@ void GD60914Component::dump_config() {
 }
 
 void GD60914Component::reset() {
-  while (this->available()) {
-    this->read();
-  }
-  this->write_array(RESET_CMD, 5);
+  this->transaction_.send(RESET_CMD, 5, nullptr, nullptr);
 }
 
 void GD60914Component::calibrate35() {
-  while (this->available()) {
-    this->read();
-  }
-  this->write_array(CALIBRATE35_CMD, 5);
+  this->transaction_.send(CALIBRATE35_CMD, 5, nullptr, nullptr);
 }
 
 void GD60914Component::calibrate42() {
-  while (this->available()) {
-    this->read();
-  }
-  this->write_array(CALIBRATE42_CMD, 5);
+  this->transaction_.send(CALIBRATE42_CMD, 5, nullptr, nullptr);
 }
 
 }
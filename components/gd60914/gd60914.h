@@ -4,6 +4,7 @@
 #include "esphome/core/automation.h"
 #include "esphome/components/sensor/sensor.h"
 #include "esphome/components/uart/uart.h"
+#include "esphome/components/uart_transaction/uart_transaction.h"
 
 namespace esphome {
 namespace gd60914 {
@@ -22,6 +23,7 @@ const static uint8_t RESET_CMD[5] = {0xA9, 0xA2, 0x01, 0x06, 0x02 };
 class GD60914Component : public PollingComponent, public uart::UARTDevice {
  public:
   void setup() override;
+  void loop() override { this->transaction_.loop(); }
   float get_setup_priority() const override { return setup_priority::DATA; };
   void update() override;
   void dump_config() override;
@@ -34,6 +36,7 @@ class GD60914Component : public PollingComponent, public uart::UARTDevice {
  protected:
   GD60914_MODE mode_;
   sensor::Sensor *temperature_sensor_{nullptr};
+  uart_transaction::UARTTransaction transaction_{this};
 };
 
 template<typename... Ts> class GD60914ResetAction : public Action<Ts...> {
@@ -13,6 +13,7 @@ from esphome.const import (
 
 CODEOWNERS = ["@synodriver"]
 DEPENDENCIES = ["uart"]
+AUTO_LOAD = ["uart_transaction"]
 
 gd60914_ns = cg.esphome_ns.namespace("gd60914")
 GD60914Component = gd60914_ns.class_("GD60914Component", cg.PollingComponent, uart.UARTDevice)
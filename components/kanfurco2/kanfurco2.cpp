@@ -1,5 +1,7 @@
 #include "kanfurco2.h"
 #include "esphome/core/log.h"
+#include "esphome/core/hal.h"
+#include <algorithm>
 
 namespace esphome {
 namespace kanfurco2 {
@@ -10,94 +12,151 @@ static const uint8_t KANFURCO2_COMMAND_CALIBRATE = 0x03;
 static const uint8_t KANFURCO2_COMMAND_VERSION = 0x1E;
 static const uint8_t KANFURCO2_COMMAND_TOGGLE_SELF_CALIBRATE = 0x10;
 static const uint8_t KANFURCO2_COMMAND_SN = 0x1F;
+static const uint32_t KANFURCO2_SETUP_INITIAL_BACKOFF = 1000;
+static const uint32_t KANFURCO2_SETUP_MAX_BACKOFF = 60000;
+static const uint8_t KANFURCO2_SETUP_MAX_INFO_ATTEMPTS = 3;  // 版本号和序列号只用于日志，失败几次就跳过
 
-// uint8_t checksum(const uint8_t *command, uint8_t size) {
-//   uint8_t sum = 0;
-//   for (uint8_t i = 0; i < size - 1; i++) {
-//     sum += command[i];
-//   }
-//   return 0xFF - sum + 0x01;
-// }
+// 应答帧：0x16 + 长度 + 命令 + 数据 + 校验，长度字节 = 命令 + 数据的字节数，全部字节相加为0
+static const uart_transaction::FrameDescriptor KANFURCO2_RESPONSE = {
+    {0x16, 0x00}, 1, uart_transaction::UART_TRANSACTION_MAX_FRAME, uart_transaction::CHECKSUM_SUM_COMPLEMENT, 0, 1, 3};
+
+// 各命令应答长度字节的最小值，保证回调里按下标取数据不越界；表里没有的命令只要求回显命令字
+struct KANFURCO2CommandInfo {
+  uint8_t command;
+  uint8_t min_length;
+};
+static const KANFURCO2CommandInfo KANFURCO2_COMMANDS[] = {
+    {KANFURCO2_COMMAND_READ, 0x05},
+    {KANFURCO2_COMMAND_CALIBRATE, 0x01},
+    {KANFURCO2_COMMAND_VERSION, 0x0C},
+    {KANFURCO2_COMMAND_TOGGLE_SELF_CALIBRATE, 0x01},
+    {KANFURCO2_COMMAND_SN, 0x06},
+};
 
 void KANFURCO2Component::setup() {
   ESP_LOGW(TAG, "setup KANFUR CO2 sensor");
-  auto version = this->version();
-  if (version.has_value()) {
-    ESP_LOGW(TAG, "version: %s", version.value().c_str());
+  // 不在这里等串口应答，传感器不在或还在预热时也不拖慢开机和联网
+  this->setup_state_ = KANFURCO2_SETUP_VERSION;
+  this->setup_pending_ = false;
+  this->setup_attempts_ = 0;
+  this->setup_last_ = millis();
+  this->setup_delay_ = 0;
+  this->setup_backoff_ = KANFURCO2_SETUP_INITIAL_BACKOFF;
+}
+
+void KANFURCO2Component::loop() {
+  this->transaction_.loop();
+  this->run_setup_();
+}
+
+void KANFURCO2Component::run_setup_() {
+  if (this->setup_state_ == KANFURCO2_SETUP_DONE || this->setup_pending_) {
+    return;
+  }
+  if (millis() - this->setup_last_ < this->setup_delay_) {
+    return;
   }
-  auto sn = this->sn();
-  if (sn.has_value()) {
-    ESP_LOGW(TAG, "sn: %s", sn.value().c_str());
+  this->setup_pending_ = true;
+  bool queued;
+  switch (this->setup_state_) {
+    case KANFURCO2_SETUP_VERSION:
+      queued = this->version();
+      break;
+    case KANFURCO2_SETUP_SN:
+      queued = this->sn();
+      break;
+    default:
+      queued = this->send_self_calibrate_(this->self_calibrate, this->period, this->base, true);
+      break;
+  }
+  if (!queued) {
+    this->on_setup_result_(this->setup_state_, false);
   }
-  this->toggle_self_calibrate(this->self_calibrate, this->period, this->base);
 }
 
-float KANFURCO2Component::get_setup_priority() const { return setup_priority::DATA; }
-
-void KANFURCO2Component::update() {
-  auto val = this->read_co2();
-  if (!val.has_value()) {
+void KANFURCO2Component::on_setup_result_(KANFURCO2_SETUP_STATE step, bool success) {
+  if (!this->setup_pending_ || this->setup_state_ != step) {
     return;
   }
-  uint32_t co2 = val.value();
-  if (this->co2_sensor_ != nullptr) {
-    this->co2_sensor_->publish_state(co2);
+  this->setup_pending_ = false;
+  this->setup_last_ = millis();
+  if (!success) {
+    this->setup_attempts_++;
+    if (step != KANFURCO2_SETUP_SELF_CALIBRATE && this->setup_attempts_ >= KANFURCO2_SETUP_MAX_INFO_ATTEMPTS) {
+      ESP_LOGW(TAG, "KANFUR CO2 setup step %u skipped after %u attempts", step, this->setup_attempts_);
+    } else {
+      ESP_LOGW(TAG, "KANFUR CO2 setup step %u failed, retry in %" PRIu32 " ms", step, this->setup_backoff_);
+      this->setup_delay_ = this->setup_backoff_;
+      this->setup_backoff_ = std::min(this->setup_backoff_ * 2, KANFURCO2_SETUP_MAX_BACKOFF);
+      return;
+    }
+  }
+  this->setup_state_ = static_cast<KANFURCO2_SETUP_STATE>(step + 1);
+  this->setup_attempts_ = 0;
+  this->setup_delay_ = 0;
+  this->setup_backoff_ = KANFURCO2_SETUP_INITIAL_BACKOFF;
+  if (this->setup_state_ == KANFURCO2_SETUP_DONE) {
+    ESP_LOGD(TAG, "KANFUR CO2 setup finished");
   }
 }
 
-optional<uint32_t> KANFURCO2Component::read_co2() {
-  uint8_t buf[8];
-  bool read_success = this->write_command(KANFURCO2_COMMAND_READ, nullptr, 0, buf);
-  if (!read_success) {
-    ESP_LOGW(TAG, "Reading data from KANFUR CO2 failed!");
-    this->status_set_warning();
-    return nullopt;
+float KANFURCO2Component::get_setup_priority() const { return setup_priority::DATA; }
+
+void KANFURCO2Component::update() {
+  if (this->checksum_errors_sensor_ != nullptr) {
+    this->checksum_errors_sensor_->publish_state(this->checksum_errors_);
   }
-  if (buf[0] != 0x16) {
-    ESP_LOGW(TAG, "KANFUR CO2 resp header error!");
-    this->status_set_warning();
-    return nullopt;
+  if (this->malformed_frames_sensor_ != nullptr) {
+    this->malformed_frames_sensor_->publish_state(this->malformed_frames_);
   }
-  return (uint32_t) (buf[3]) * 256 + (uint32_t) buf[4];
+  this->read_co2();
+}
+
+void KANFURCO2Component::read_co2() {
+  this->write_command(KANFURCO2_COMMAND_READ, nullptr, 0,
+                      [this](uart_transaction::TransactionStatus status, const uint8_t *buf, uint8_t len) {
+                        if (status != uart_transaction::TRANSACTION_OK) {
+                          ESP_LOGW(TAG, "Reading data from KANFUR CO2 failed!");
+                          this->status_set_warning();
+                          return;
+                        }
+                        this->status_clear_warning();
+                        uint32_t co2 = (uint32_t) (buf[3]) * 256 + (uint32_t) buf[4];
+                        if (this->co2_sensor_ != nullptr) {
+                          this->co2_sensor_->publish_state(co2);
+                        }
+                      });
 }
 
 void KANFURCO2Component::calibrate(uint16_t c) {
-  uint8_t buf[4];
   uint8_t data[2];
   data[0] = c >> 8;
   data[1] = c & 0xFF;
-  bool read_success = this->write_command(KANFURCO2_COMMAND_CALIBRATE, data, 2, buf);
-  if (!read_success) {
-    ESP_LOGW(TAG, "Reading data from KANFUR CO2 failed!");
-    this->status_set_warning();
-    return;
-  }
-  if (buf[0] != 0x16 || buf[1] != 0x01 || buf[2] != 0x03 || buf[3] != 0xE6) {
-    ESP_LOGW(TAG, "KANFUR CO2 resp header error!");
-    this->status_set_warning();
-    return;
-  }
+  this->write_command(KANFURCO2_COMMAND_CALIBRATE, data, 2,
+                      [this](uart_transaction::TransactionStatus status, const uint8_t *buf, uint8_t len) {
+                        if (status != uart_transaction::TRANSACTION_OK) {
+                          ESP_LOGW(TAG, "KANFUR CO2 calibration command failed!");
+                          this->status_set_warning();
+                        }
+                      });
 }
 
-optional<std::string> KANFURCO2Component::version() {
-  uint8_t buf[15];
-  bool read_success = this->write_command(KANFURCO2_COMMAND_VERSION, nullptr, 0, buf);
-  if (!read_success) {
-    ESP_LOGW(TAG, "Reading data from KANFUR CO2 failed!");
-    this->status_set_warning();
-    return nullopt;
-  }
-  if (buf[0] != 0x16 || buf[1] != 0x0C || buf[2] != 0x1E) {
-    ESP_LOGW(TAG, "KANFUR CO2 resp header error!");
-    this->status_set_warning();
-    return nullopt;
-  }
-  std::string str(reinterpret_cast<const char *>(buf + 3), 10);
-  return str;
+bool KANFURCO2Component::version() {
+  return this->write_command(
+      KANFURCO2_COMMAND_VERSION, nullptr, 0,
+      [this](uart_transaction::TransactionStatus status, const uint8_t *buf, uint8_t len) {
+        if (status != uart_transaction::TRANSACTION_OK) {
+          ESP_LOGW(TAG, "Reading KANFUR CO2 version failed!");
+          this->on_setup_result_(KANFURCO2_SETUP_VERSION, false);
+          return;
+        }
+        std::string str(reinterpret_cast<const char *>(buf + 3), 10);
+        ESP_LOGD(TAG, "version: %s", str.c_str());
+        this->on_setup_result_(KANFURCO2_SETUP_VERSION, true);
+      });
 }
 
-void KANFURCO2Component::toggle_self_calibrate(bool open, uint8_t period, uint16_t base) {
-  uint8_t buf[4];
+bool KANFURCO2Component::send_self_calibrate_(bool open, uint8_t period, uint16_t base, bool from_setup) {
   uint8_t data[6] = {100, 0, 7, 0, 0, 100};
   if (!open) {
     data[1] = 2;
@@ -105,83 +164,83 @@ void KANFURCO2Component::toggle_self_calibrate(bool open, uint8_t period, uint16
   data[2] = period;
   data[3] = base >> 8;
   data[4] = base & 0xFF;
-  bool read_success = this->write_command(KANFURCO2_COMMAND_TOGGLE_SELF_CALIBRATE, data, 6, buf);
-  if (!read_success) {
-    ESP_LOGW(TAG, "Reading data from KANFUR CO2 failed!");
-    this->status_set_warning();
-    return;
-  }
-  if (buf[0] != 0x16 || buf[1] != 0x01 || buf[2] != 0x10 || buf[3] != 0xD9) {
-    ESP_LOGW(TAG, "KANFUR CO2 resp header error!");
-    this->status_set_warning();
-    return;
-  }
+  return this->write_command(
+      KANFURCO2_COMMAND_TOGGLE_SELF_CALIBRATE, data, 6,
+      [this, open, from_setup](uart_transaction::TransactionStatus status, const uint8_t *buf, uint8_t len) {
+        bool success = true;
+        if (status != uart_transaction::TRANSACTION_OK) {
+          ESP_LOGW(TAG, "KANFUR CO2 self-calibration %s command failed!", open ? "enable" : "disable");
+          this->status_set_warning();
+          success = false;
+        }
+        if (from_setup) {
+          this->on_setup_result_(KANFURCO2_SETUP_SELF_CALIBRATE, success);
+        }
+      });
 }
 
-optional<std::string> KANFURCO2Component::sn() {
-  uint8_t buf[9];
-  bool read_success = this->write_command(KANFURCO2_COMMAND_SN, nullptr, 0, buf);
-  if (!read_success) {
-    ESP_LOGW(TAG, "Reading data from KANFUR CO2 failed!");
-    this->status_set_warning();
-    return nullopt;
-  }
-  if (buf[0] != 0x16) {
-    ESP_LOGW(TAG, "KANFUR CO2 resp header error!");
-    this->status_set_warning();
-    return nullopt;
-  }
-  std::string str(reinterpret_cast<const char *>(buf + 3), 5);
-  return str;
+bool KANFURCO2Component::sn() {
+  return this->write_command(KANFURCO2_COMMAND_SN, nullptr, 0,
+                             [this](uart_transaction::TransactionStatus status, const uint8_t *buf, uint8_t len) {
+                               if (status != uart_transaction::TRANSACTION_OK) {
+                                 ESP_LOGW(TAG, "Reading KANFUR CO2 serial number failed!");
+                                 this->on_setup_result_(KANFURCO2_SETUP_SN, false);
+                                 return;
+                               }
+                               std::string str(reinterpret_cast<const char *>(buf + 3), 5);
+                               ESP_LOGD(TAG, "sn: %s", str.c_str());
+                               this->on_setup_result_(KANFURCO2_SETUP_SN, true);
+                             });
 }
 
-bool KANFURCO2Component::write_command(uint8_t command, const uint8_t *data, uint8_t data_size, uint8_t *response_buf) {
-  while (this->available()) {
-    this->read();
-  }  // clear rx buf
-  uint8_t checksum = KANFURCO2_HEAD;
-  this->write(KANFURCO2_HEAD);
-  this->write(data_size + 1);
-  checksum += (data_size + 1);
-  this->write(command);
-  checksum += command;
-  if (data != nullptr) {
-    this->write_array(data, data_size);
-    for (uint8_t i = 0; i < data_size; i++) {
-      checksum += data[i];
-    }
-  }
-  checksum = 0xFF - checksum + 0x01;
-  this->write(checksum);
-  this->flush();
-  if (response_buf == nullptr) {
-    return true;
-  }
-  switch (command) {
-    case KANFURCO2_COMMAND_READ: {
-      return this->read_array(response_buf, 8);
-    }
-    case KANFURCO2_COMMAND_CALIBRATE: {
-      return this->read_array(response_buf, 4);
-    }
-    case KANFURCO2_COMMAND_VERSION: {
-      return this->read_array(response_buf, 15);
-    }
-    case KANFURCO2_COMMAND_TOGGLE_SELF_CALIBRATE: {
-      return this->read_array(response_buf, 4);
-    }
-    case KANFURCO2_COMMAND_SN: {
-      return this->read_array(response_buf, 9);
-    }
-    default: {
-      return false;
+bool KANFURCO2Component::write_command(uint8_t command, const uint8_t *data, uint8_t data_size,
+                                       uart_transaction::ResponseCallback &&callback) {
+  // 0x11 + 长度 + 命令 + 数据 + 校验
+  uint8_t frame[uart_transaction::UART_TRANSACTION_MAX_REQUEST];
+  if (data_size + 4 > uart_transaction::UART_TRANSACTION_MAX_REQUEST) {
+    return false;
+  }
+  frame[0] = KANFURCO2_HEAD;
+  frame[1] = data_size + 1;
+  frame[2] = command;
+  for (uint8_t i = 0; i < data_size; i++) {
+    frame[3 + i] = data[i];
+  }
+  frame[3 + data_size] =
+      uart_transaction::compute_checksum(uart_transaction::CHECKSUM_SUM_COMPLEMENT, frame, 3 + data_size);
+
+  uint8_t min_length = 0x01;
+  for (const auto &info : KANFURCO2_COMMANDS) {
+    if (info.command == command) {
+      min_length = info.min_length;
+      break;
     }
   }
+  // 长度和校验由传输层检查，这里再核对回显的命令字和数据长度，并统计坏帧
+  return this->transaction_.send(
+      frame, data_size + 4, &KANFURCO2_RESPONSE,
+      [this, command, min_length, callback = std::move(callback)](uart_transaction::TransactionStatus status,
+                                                                  const uint8_t *buf, uint8_t len) {
+        if (status == uart_transaction::TRANSACTION_OK && (buf[2] != command || buf[1] < min_length)) {
+          ESP_LOGW(TAG, "KANFUR CO2 unexpected response: command 0x%02X, length %u", buf[2], buf[1]);
+          status = uart_transaction::TRANSACTION_MALFORMED;
+        }
+        if (status == uart_transaction::TRANSACTION_CHECKSUM_ERROR) {
+          this->checksum_errors_++;
+        } else if (status == uart_transaction::TRANSACTION_MALFORMED) {
+          this->malformed_frames_++;
+        }
+        if (callback) {
+          callback(status, buf, len);
+        }
+      });
 }
 
 void KANFURCO2Component::dump_config() {
   ESP_LOGCONFIG(TAG, "KANFUR CO2:");
   LOG_SENSOR("  ", "CO2", this->co2_sensor_);
+  LOG_SENSOR("  ", "Checksum Errors", this->checksum_errors_sensor_);
+  LOG_SENSOR("  ", "Malformed Frames", this->malformed_frames_sensor_);
   this->check_uart_settings(9600);
 }
 }  // namespace kanfurco2
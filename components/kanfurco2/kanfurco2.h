@@ -4,6 +4,7 @@
 #include "esphome/core/automation.h"
 #include "esphome/components/sensor/sensor.h"
 #include "esphome/components/uart/uart.h"
+#include "esphome/components/uart_transaction/uart_transaction.h"
 
 namespace esphome {
 namespace kanfurco2 {
@@ -11,28 +12,66 @@ namespace kanfurco2 {
 // enum DARTABCLogic { DART_ABC_NONE = 0, DART_ABC_ENABLED, DART_ABC_DISABLED };
 #define SB1_BUFFER_LEN 6  // Length of serial buffer for header + type + length
 
+// 开机配置步骤，在loop()里逐步执行，失败按退避时间重试
+enum KANFURCO2_SETUP_STATE : uint8_t {
+  KANFURCO2_SETUP_VERSION = 0,
+  KANFURCO2_SETUP_SN,
+  KANFURCO2_SETUP_SELF_CALIBRATE,
+  KANFURCO2_SETUP_DONE,
+};
+
 class KANFURCO2Component : public PollingComponent, public uart::UARTDevice {
  public:
   void setup() override;
+  void loop() override;
   float get_setup_priority() const override;
   void update() override;
   void dump_config() override;
   void set_co2_sensor(sensor::Sensor *co2_sensor) { co2_sensor_ = co2_sensor; }
+  void set_checksum_errors_sensor(sensor::Sensor *checksum_errors_sensor) {
+    this->checksum_errors_sensor_ = checksum_errors_sensor;
+  }
+  void set_malformed_frames_sensor(sensor::Sensor *malformed_frames_sensor) {
+    this->malformed_frames_sensor_ = malformed_frames_sensor;
+  }
+  uint32_t get_checksum_errors() const { return this->checksum_errors_; }
+  uint32_t get_malformed_frames() const { return this->malformed_frames_; }
   void set_self_calibrate(bool b) { self_calibrate = b; }
   void set_period(uint8_t p) { period = p; }
   void set_base(uint16_t b) { base = b; }
   void calibrate(uint16_t data);
-  optional<std::string> version();
-  void toggle_self_calibrate(bool open, uint8_t period, uint16_t base);
-  optional<std::string> sn();
+  // 以下请求都是异步的，应答在loop()中收齐后处理；返回false表示没能排队
+  bool version();
+  bool toggle_self_calibrate(bool open, uint8_t period, uint16_t base) {
+    return this->send_self_calibrate_(open, period, base, false);
+  }
+  bool sn();
 
  protected:
   bool self_calibrate;
   uint8_t period;
   uint16_t base;
-  optional<uint32_t> read_co2();
-  bool write_command(uint8_t command, const uint8_t *data, uint8_t data_size, uint8_t *response_buf);
+  void read_co2();
+  // 组帧并排队发送，应答按长度字节收齐并校验后回调
+  bool write_command(uint8_t command, const uint8_t *data, uint8_t data_size,
+                     uart_transaction::ResponseCallback &&callback);
   sensor::Sensor *co2_sensor_{nullptr};
+  // 应答坏帧统计
+  uint32_t checksum_errors_{0};
+  uint32_t malformed_frames_{0};
+  sensor::Sensor *checksum_errors_sensor_{nullptr};
+  sensor::Sensor *malformed_frames_sensor_{nullptr};
+  uart_transaction::UARTTransaction transaction_{this};
+
+  bool send_self_calibrate_(bool open, uint8_t period, uint16_t base, bool from_setup);
+  void run_setup_();
+  void on_setup_result_(KANFURCO2_SETUP_STATE step, bool success);
+  KANFURCO2_SETUP_STATE setup_state_{KANFURCO2_SETUP_VERSION};
+  bool setup_pending_{false};  // 当前步骤的请求已发出，等待应答
+  uint8_t setup_attempts_{0};
+  uint32_t setup_last_{0};
+  uint32_t setup_delay_{0};  // 距setup_last_多久后执行当前步骤
+  uint32_t setup_backoff_{0};
 };
 
 template<typename... Ts> class ToggleSelfCalibrateAction : public Action<Ts...> {
@@ -10,14 +10,18 @@ from esphome.const import (
     UNIT_PARTS_PER_MILLION,
     ICON_MOLECULE_CO2,
     STATE_CLASS_MEASUREMENT, CONF_PERIOD,
+    STATE_CLASS_TOTAL_INCREASING,
 )
 
 CODEOWNERS = ["@synodriver"]
 DEPENDENCIES = ["uart"]
+AUTO_LOAD = ["uart_transaction"]
 
 CONF_SELF_CALIBRATE = "self_calibrate"
 CONF_BASE = "base"
 CONF_OPEN = "open"
+CONF_CHECKSUM_ERRORS = "checksum_errors"
+CONF_MALFORMED_FRAMES = "malformed_frames"
 
 kanfurco2 = cg.esphome_ns.namespace("kanfurco2")
 KANFURCO2Component = kanfurco2.class_("KANFURCO2Component", cg.PollingComponent, uart.UARTDevice)
@@ -35,6 +39,17 @@ CONFIG_SCHEMA = cv.All(
             cv.Optional(CONF_SELF_CALIBRATE, default=True): cv.boolean,
             cv.Optional(CONF_PERIOD, default=7): cv.int_,
             cv.Optional(CONF_BASE, default=400): cv.int_,
+            # 应答坏帧统计
+            cv.Optional(CONF_CHECKSUM_ERRORS): sensor.sensor_schema(
+                icon="mdi:counter",
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_TOTAL_INCREASING,
+            ),
+            cv.Optional(CONF_MALFORMED_FRAMES): sensor.sensor_schema(
+                icon="mdi:counter",
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_TOTAL_INCREASING,
+            ),
         }
     )
     .extend(cv.polling_component_schema("20s"))
@@ -98,3 +113,9 @@ async def to_code(config):
     if CONF_CO2 in config:
         sens = await sensor.new_sensor(config[CONF_CO2])
         cg.add(var.set_co2_sensor(sens))  # KANFURCO2Component::set_co2_sensor
+    if CONF_CHECKSUM_ERRORS in config:
+        sens = await sensor.new_sensor(config[CONF_CHECKSUM_ERRORS])
+        cg.add(var.set_checksum_errors_sensor(sens))
+    if CONF_MALFORMED_FRAMES in config:
+        sens = await sensor.new_sensor(config[CONF_MALFORMED_FRAMES])
+        cg.add(var.set_malformed_frames_sensor(sens))
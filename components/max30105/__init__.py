@@ -84,6 +84,13 @@ CONF_ALC_OVERFLOW = "alc_overflow"
 CONF_PROX_INT = "prox_int"
 CONF_TEMPERATURE_READY = "temp_ready"
 CONF_PROXIMITY_THRESHOLD = "proximity_threshold"
+CONF_PROXIMITY_GATING = "proximity_gating"
+CONF_ABSENCE_TIMEOUT = "absence_timeout"
+CONF_AUTO_GAIN = "auto_gain"
+CONF_LOW_THRESHOLD = "low_threshold"
+CONF_HIGH_THRESHOLD = "high_threshold"
+CONF_MIN_CURRENT = "min_current"
+CONF_MAX_CURRENT = "max_current"
 
 CONF_ON_POWER_READY = "on_power_ready"
 CONF_ON_FIFO_ALMOST_FULL = "on_fifo_almost_full"
@@ -91,6 +98,12 @@ CONF_ON_DATA_READY = "on_data_ready"
 CONF_ON_ALC_OVERFLOW = "on_alc_overflow"
 CONF_ON_PROX_INT = "on_prox_int"
 CONF_ON_TEMPERATURE_READY = "on_temperature_ready"
+CONF_ON_STREAM_FRAME = "on_stream_frame"
+CONF_TEMPERATURE_INTERVAL = "temperature_interval"
+CONF_TEMPERATURE_COMPENSATION = "temperature_compensation"
+CONF_REFERENCE_TEMPERATURE = "reference_temperature"
+CONF_LED_COEFFICIENTS = ["led1", "led2", "led3", "led4"]
+CONF_STREAM_SAMPLES_PER_FRAME = "stream_samples_per_frame"
 
 PowerReadyTrigger = max30105_ns.class_("PowerReadyTrigger", automation.Trigger.template())
 FifoAlmostFullTrigger = max30105_ns.class_("FifoAlmostFullTrigger", automation.Trigger.template())
@@ -98,6 +111,23 @@ DataReadyTrigger = max30105_ns.class_("DataReadyTrigger", automation.Trigger.tem
 ALCOverflowTrigger = max30105_ns.class_("ALCOverflowTrigger", automation.Trigger.template())
 ProximityInterruptTrigger = max30105_ns.class_("ProximityInterruptTrigger", automation.Trigger.template())
 TemperatureReadyTrigger = max30105_ns.class_("TemperatureReadyTrigger", automation.Trigger.template(cg.float_))
+StreamFrameRef = cg.std_vector.template(cg.uint8).operator("const").operator("ref")
+StreamFrameTrigger = max30105_ns.class_("StreamFrameTrigger", automation.Trigger.template(StreamFrameRef))
+
+def validate_proximity_gating(config):
+    # 接近模式切换只能通过PROX_INT中断得知
+    if config[CONF_PROXIMITY_GATING] and CONF_INTERRUPT_PIN not in config:
+        raise cv.Invalid(f"{CONF_PROXIMITY_GATING} requires {CONF_INTERRUPT_PIN}")
+    return config
+
+
+def validate_auto_gain(config):
+    if config[CONF_LOW_THRESHOLD] >= config[CONF_HIGH_THRESHOLD]:
+        raise cv.Invalid(f"{CONF_LOW_THRESHOLD} must be lower than {CONF_HIGH_THRESHOLD}")
+    if config[CONF_MIN_CURRENT] >= config[CONF_MAX_CURRENT]:
+        raise cv.Invalid(f"{CONF_MIN_CURRENT} must be lower than {CONF_MAX_CURRENT}")
+    return config
+
 
 CONFIG_SCHEMA = cv.All(
     cv.Schema(
@@ -122,6 +152,19 @@ CONFIG_SCHEMA = cv.All(
             cv.Optional(CONF_TEMPERATURE_READY, default=False): cv.boolean,
 
             cv.Optional(CONF_PROXIMITY_THRESHOLD, default=100): cv.int_range(min=0, max=255),
+            cv.Optional(CONF_PROXIMITY_GATING, default=False): cv.boolean,
+            cv.Optional(CONF_ABSENCE_TIMEOUT, default="10s"): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_AUTO_GAIN): cv.All(
+                cv.Schema(
+                    {
+                        cv.Optional(CONF_LOW_THRESHOLD, default="25%"): cv.percentage,
+                        cv.Optional(CONF_HIGH_THRESHOLD, default="75%"): cv.percentage,
+                        cv.Optional(CONF_MIN_CURRENT, default=0x05): cv.int_range(min=0x00, max=0xFF),
+                        cv.Optional(CONF_MAX_CURRENT, default=0xFF): cv.int_range(min=0x00, max=0xFF),
+                    }
+                ),
+                validate_auto_gain,
+            ),
 
             cv.Optional(CONF_INTERRUPT_PIN): cv.All(
                 pins.internal_gpio_input_pin_schema
@@ -156,10 +199,27 @@ CONFIG_SCHEMA = cv.All(
                     cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(TemperatureReadyTrigger),
                 }
             ),
+            cv.Optional(CONF_STREAM_SAMPLES_PER_FRAME, default=16): cv.int_range(min=1, max=32),
+            cv.Optional(CONF_TEMPERATURE_INTERVAL, default="60s"): cv.positive_time_period_milliseconds,
+            # 各LED的温度漂移系数，单位%/°C
+            cv.Optional(CONF_TEMPERATURE_COMPENSATION): cv.Schema(
+                {
+                    cv.Optional(CONF_REFERENCE_TEMPERATURE, default=25.0): cv.temperature,
+                    **{cv.Optional(key, default=0.0): cv.float_range(min=-10.0, max=10.0)
+                       for key in CONF_LED_COEFFICIENTS},
+                }
+            ),
+            # 每帧打包多个样本的二进制数据流，lambda中通过frame引用帧内容
+            cv.Optional(CONF_ON_STREAM_FRAME): automation.validate_automation(
+                {
+                    cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(StreamFrameTrigger),
+                }
+            ),
         }
     )
     .extend(cv.polling_component_schema("20s"))
     .extend(i2c.i2c_device_schema(0x57)),
+    validate_proximity_gating,
 )
 
 FINAL_VALIDATE_SCHEMA = i2c.final_validate_device_schema("max30105", max_frequency="400khz")
@@ -184,6 +244,11 @@ async def to_code(config):
                               config[CONF_ALC_OVERFLOW], config[CONF_PROX_INT], config[CONF_TEMPERATURE_READY]))
 
     cg.add(var.set_proximity_threshold(config[CONF_PROXIMITY_THRESHOLD]))
+    cg.add(var.set_proximity_gating(config[CONF_PROXIMITY_GATING]))
+    cg.add(var.set_absence_timeout(config[CONF_ABSENCE_TIMEOUT]))
+    if auto_gain := config.get(CONF_AUTO_GAIN):
+        cg.add(var.set_auto_gain(auto_gain[CONF_LOW_THRESHOLD], auto_gain[CONF_HIGH_THRESHOLD],
+                                 auto_gain[CONF_MIN_CURRENT], auto_gain[CONF_MAX_CURRENT]))
     if pin := config.get(CONF_INTERRUPT_PIN):
         interrupt_pin = await cg.gpio_pin_expression(pin)
         cg.add(var.set_interrupt_pin(interrupt_pin))
@@ -205,6 +270,15 @@ async def to_code(config):
     for conf in config.get(CONF_ON_TEMPERATURE_READY, []):
         trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
         await automation.build_automation(trigger, [(cg.float_, "temperature"), ], conf)  # 中间是trigger中可以引用的变量的名字和类型
+    cg.add(var.set_stream_samples_per_frame(config[CONF_STREAM_SAMPLES_PER_FRAME]))
+    cg.add(var.set_temperature_interval(config[CONF_TEMPERATURE_INTERVAL]))
+    if compensation := config.get(CONF_TEMPERATURE_COMPENSATION):
+        cg.add(var.set_temperature_reference(compensation[CONF_REFERENCE_TEMPERATURE]))
+        for led, key in enumerate(CONF_LED_COEFFICIENTS):
+            cg.add(var.set_temperature_coefficient(led, compensation[key] / 100.0))
+    for conf in config.get(CONF_ON_STREAM_FRAME, []):
+        trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
+        await automation.build_automation(trigger, [(StreamFrameRef, "frame"), ], conf)
 
 
 # 无参数automation
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// FIFO相关的纯计算，不依赖esphome和I2C，可以直接在主机上编译验证
+namespace esphome {
+namespace max30105 {
+
+static const uint8_t MAX30105_FIFO_DEPTH = 32;  // 芯片FIFO深度（样本数）
+static const uint8_t MAX30105_MAX_LEDS = 4;     // 每个样本最多4个时隙
+
+// 一个完整的多LED样本，timestamp为按采样率插值得到的micros()时间
+struct MAX30105Sample {
+  uint32_t timestamp;
+  std::array<uint32_t, MAX30105_MAX_LEDS> led;
+};
+
+// FIFO中待读的样本数。读写指针都是5位，相等时FIFO可能为空也可能为满，
+// 满时芯片会递增溢出计数，据此区分
+inline uint8_t fifo_pending_samples(uint8_t wr_ptr, uint8_t rd_ptr, uint8_t ovf_counter) {
+  uint8_t num_samples = (wr_ptr - rd_ptr) & (MAX30105_FIFO_DEPTH - 1);
+  if (num_samples == 0 && ovf_counter > 0) {
+    return MAX30105_FIFO_DEPTH;
+  }
+  return num_samples;
+}
+
+// 解码一个样本：每个时隙3字节大端，有效数据为低18位，按分辨率右移shift位
+inline void decode_fifo_sample(const uint8_t *data, uint8_t active_leds, uint8_t shift, MAX30105Sample &sample) {
+  for (uint8_t i = 0; i < active_leds; i++) {
+    uint32_t raw = (((uint32_t) data[i * 3]) << 16) | (((uint32_t) data[i * 3 + 1]) << 8) | ((uint32_t) data[i * 3 + 2]);
+    sample.led[i] = (raw & 0x03FFFF) >> shift;
+  }
+}
+
+// FIFO的实际输出周期 = 平均次数 / 采样率，参数为寄存器编码值
+inline uint32_t fifo_sample_period_us(uint8_t sample_rate, uint8_t sample_avg) {
+  static const uint16_t SAMPLE_RATES[] = {50, 100, 200, 400, 800, 1000, 1600, 3200};
+  uint32_t averaging = 1 << (sample_avg > 5 ? 5 : sample_avg);
+  return 1000000UL * averaging / SAMPLE_RATES[sample_rate & 0x07];
+}
+
+}  // namespace max30105
+}  // namespace esphome
@@ -34,6 +34,8 @@ static const uint8_t REG_PART_ID = 0xFF;
 
 static const uint8_t EXPECTED_PART_ID = 0x15;
 
+static const float AGC_NO_TARGET_LEVEL = 0.01f;  // 低于满量程1%认为没有目标
+
 void IRAM_ATTR MAX30105Component::irq(MAX30105Component *c) { c->interrupt_ = true; }
 
 void MAX30105Component::setup() {
@@ -44,13 +46,13 @@ void MAX30105Component::setup() {
   }
   this->reset();
   this->clear_fifo();
-  this->reg(REG_FIFO_CONFIG) =
-      ((this->sample_avg_ << 5) | (static_cast<uint8_t>(this->fifo_rollover_) << 4) | (this->fifo_threshold_));
+  this->write_reg_(REG_FIFO_CONFIG,
+                   (this->sample_avg_ << 5) | (static_cast<uint8_t>(this->fifo_rollover_) << 4) | this->fifo_threshold_);
 
   this->set_mode_reg(this->mode_);
 
   uint8_t spo2_config = (this->adc_range_ << 5) | (this->sample_rate_ << 2) | this->resolution_;
-  this->reg(REG_SPO2_CONFIG) = spo2_config;
+  this->write_reg_(REG_SPO2_CONFIG, spo2_config);
 
   this->set_led_current_reg(this->red_current_, this->ir_current_, this->green_current_, this->pilot_current_);
 
@@ -66,11 +68,22 @@ void MAX30105Component::setup() {
     data.push_back(MAX30105_SLOT_GREEN);
   }  // todo MAX30105_SLOT_RED_PILOT?
   this->set_multi_led_slots_reg(data);
+  if (this->stream_enabled_) {
+    this->stream_frame_.reserve(MAX30105_STREAM_MAX_FRAME_SIZE);
+  }
+  // 所有模式下时隙1都是红光、时隙2都是红外
+  this->ppg_.configure(1000000.0f / this->get_sample_period_us(), 0x03FFFF >> (3 - this->resolution_));
 
-  this->enable_interrupts(this->fifo_almost_full_, this->data_ready_, this->alc_overflow_, this->prox_int_,
-                          this->temp_ready_);
+  // 接近门控依赖芯片的接近模式，必须打开PROX_INT
+  // 温度转换结果由TEMP_RDY中断读取，有中断引脚时总是打开
+  this->enable_interrupts(this->fifo_almost_full_, this->data_ready_, this->alc_overflow_,
+                          this->prox_int_ || this->proximity_gating_,
+                          this->temp_ready_ || this->interrupt_pin_ != nullptr);
 
   this->set_proximity_threshold_reg(this->proximity_threshold_);
+  if (this->proximity_gating_) {
+    this->enter_idle_();
+  }
 
   if (this->interrupt_pin_ != nullptr) {
     this->interrupt_pin_->pin_mode(gpio::FLAG_INPUT | gpio::FLAG_PULLUP);
@@ -78,12 +91,25 @@ void MAX30105Component::setup() {
     this->interrupt_pin_->attach_interrupt(MAX30105Component::irq, this, gpio::INTERRUPT_FALLING_EDGE);
   }
   this->simulate_interrupt(); // 貌似不读一次寄存器的话，后续中断不会发生
+  // 芯片温度按独立的较低频率转换，不再每次update都触发
+  this->read_temperature();
+  this->set_interval("temperature", this->temperature_interval_, [this]() { this->read_temperature(); });
 }
 
 void MAX30105Component::update() {
-  this->read_temperature();
-  this->read_fifo();
+  if (this->power_state_ == MAX30105_POWER_ACTIVE && this->proximity_gating_ &&
+      millis() - this->last_presence_ > this->absence_timeout_) {
+    this->enter_idle_();
+  }
+  if (this->power_state_ == MAX30105_POWER_ACTIVE && !this->fifo_interrupt_driven_()) {
+    this->read_fifo();  // 没有FIFO_A_FULL中断时才靠轮询读取
+  }
+  if (this->power_state_ == MAX30105_POWER_ACTIVE && this->agc_enabled_) {
+    this->run_agc_();
+  }
   this->read_overflow_counter();
+  this->publish_ppg_();
+  this->publish_events_();
 }
 
 void MAX30105Component::dump_config() {
@@ -102,87 +128,294 @@ void MAX30105Component::dump_config() {
   ESP_LOGCONFIG(TAG, "  Green Current amp: %d", this->green_current_);
   ESP_LOGCONFIG(TAG, "  Pilot Current amp: %d", this->pilot_current_);
 
+  ESP_LOGCONFIG(TAG, "  Sample Period: %u us", (unsigned) this->get_sample_period_us());
+  ESP_LOGCONFIG(TAG, "  Sample Buffer: %u samples", MAX30105_SAMPLE_BUFFER_SIZE);
+  if (this->agc_enabled_) {
+    ESP_LOGCONFIG(TAG, "  Auto Gain: %.0f%% ~ %.0f%%, current %u ~ %u", this->agc_low_ * 100, this->agc_high_ * 100,
+                  this->agc_min_current_, this->agc_max_current_);
+  }
+  ESP_LOGCONFIG(TAG, "  Temperature Interval: %u ms", (unsigned) this->temperature_interval_);
+  if (this->temp_comp_enabled_) {
+    ESP_LOGCONFIG(TAG, "  Temperature Compensation: reference %.1f°C, %.3f/%.3f/%.3f/%.3f %%/°C",
+                  this->temp_comp_reference_, this->temp_comp_coefficients_[0] * 100,
+                  this->temp_comp_coefficients_[1] * 100, this->temp_comp_coefficients_[2] * 100,
+                  this->temp_comp_coefficients_[3] * 100);
+  }
+  if (this->stream_enabled_) {
+    ESP_LOGCONFIG(TAG, "  Stream: %u samples per frame", this->stream_samples_per_frame_);
+  }
+  if (this->proximity_gating_) {
+    ESP_LOGCONFIG(TAG, "  Proximity Gating: absence timeout %u ms", (unsigned) this->absence_timeout_);
+  }
+  ESP_LOGCONFIG(TAG, "  FIFO Readout: %s", this->fifo_interrupt_driven_() ? "FIFO_A_FULL interrupt" : "polling");
+
   LOG_SENSOR("    ", "Temperature Sensor", this->temperature_sensor_);
   LOG_SENSOR("    ", "LED1 Sensor", this->led1_sensor_);
   LOG_SENSOR("    ", "LED2 Sensor", this->led2_sensor_);
   LOG_SENSOR("    ", "LED3 Sensor", this->led3_sensor_);
   LOG_SENSOR("    ", "LED4 Sensor", this->led4_sensor_);
   LOG_SENSOR("    ", "FIFO Overflow Counter Sensor", this->fifo_overflow_counter_sensor_);
-
-  LOG_BINARY_SENSOR("    ", "Power Ready Binary Sensor", this->power_ready_binary_sensor_);
-  LOG_BINARY_SENSOR("    ", "Target Binary Sensor", this->target_binary_sensor_);
-  LOG_BINARY_SENSOR("    ", "ALC Overflow Binary Sensor", this->alc_overflow_binary_sensor_);
-  LOG_BINARY_SENSOR("    ", "Data Ready Binary Sensor", this->data_ready_binary_sensor_);
-  LOG_BINARY_SENSOR("    ", "FIFO Full Binary Sensor", this->fifo_full_binary_sensor_);
-  LOG_BINARY_SENSOR("    ", "Temperature Ready Binary Sensor", this->temperature_ready_binary_sensor_);
+  LOG_SENSOR("    ", "Heart Rate Sensor", this->heart_rate_sensor_);
+  LOG_SENSOR("    ", "SpO2 Sensor", this->spo2_sensor_);
+  LOG_SENSOR("    ", "Signal Quality Sensor", this->signal_quality_sensor_);
+
+  LOG_BINARY_SENSOR("    ", "Power Ready Binary Sensor", this->event_binary_sensors_[MAX30105_EVENT_POWER_READY]);
+  LOG_BINARY_SENSOR("    ", "Target Binary Sensor", this->event_binary_sensors_[MAX30105_EVENT_PROXIMITY]);
+  LOG_BINARY_SENSOR("    ", "ALC Overflow Binary Sensor", this->event_binary_sensors_[MAX30105_EVENT_ALC_OVERFLOW]);
+  LOG_BINARY_SENSOR("    ", "Data Ready Binary Sensor", this->event_binary_sensors_[MAX30105_EVENT_DATA_READY]);
+  LOG_BINARY_SENSOR("    ", "FIFO Full Binary Sensor", this->event_binary_sensors_[MAX30105_EVENT_FIFO_FULL]);
+  LOG_BINARY_SENSOR("    ", "Temperature Ready Binary Sensor", this->event_binary_sensors_[MAX30105_EVENT_TEMP_READY]);
+  LOG_SENSOR("    ", "Power Ready Events", this->event_count_sensors_[MAX30105_EVENT_POWER_READY]);
+  LOG_SENSOR("    ", "Proximity Events", this->event_count_sensors_[MAX30105_EVENT_PROXIMITY]);
+  LOG_SENSOR("    ", "ALC Overflow Events", this->event_count_sensors_[MAX30105_EVENT_ALC_OVERFLOW]);
+  LOG_SENSOR("    ", "Data Ready Events", this->event_count_sensors_[MAX30105_EVENT_DATA_READY]);
+  LOG_SENSOR("    ", "FIFO Full Events", this->event_count_sensors_[MAX30105_EVENT_FIFO_FULL]);
+  LOG_SENSOR("    ", "Temperature Ready Events", this->event_count_sensors_[MAX30105_EVENT_TEMP_READY]);
 }
 
 void MAX30105Component::read_fifo() {
-  uint8_t wr_ptr = this->reg(REG_FIFO_WR_PTR).get();  // 获取FIFO写指针
-  uint8_t rd_ptr = this->reg(REG_FIFO_RD_PTR).get();  // 获取FIFO读指针
+  // FIFO_WR_PTR、OVF_COUNTER、FIFO_RD_PTR地址连续，一次读出
+  uint8_t ptrs[3];
+  if (this->read_register(REG_FIFO_WR_PTR, ptrs, 3) != i2c::ERROR_OK) {
+    return;
+  }
+  uint8_t wr_ptr = ptrs[0];  // FIFO写指针
+  uint8_t ovf = ptrs[1];     // 溢出计数
+  uint8_t rd_ptr = ptrs[2];  // FIFO读指针
   if (this->wr_ptr_sensor_ != nullptr) {
     this->wr_ptr_sensor_->publish_state(wr_ptr);  // 发布写指针状态
   }
   if (this->rd_ptr_sensor_ != nullptr) {
     this->rd_ptr_sensor_->publish_state(rd_ptr);  // 发布读指针状态
   }
-//  uint8_t num_samples = 32 + wr_ptr - rd_ptr if wr_ptr < rd_ptr else wr_ptr - rd_ptr;
-  uint8_t num_samples = 0;
-  if (wr_ptr < rd_ptr) {
-    num_samples = 32 + wr_ptr - rd_ptr;
-  } else {
-    num_samples = wr_ptr - rd_ptr;
-  }
-  num_samples %= 32;
+  uint8_t num_samples = fifo_pending_samples(wr_ptr, rd_ptr, ovf);
   if (num_samples == 0) {
-    if (this->reg(REG_OVF_COUNTER).get() > 0) {
-      wr_ptr += 1;
-      if (wr_ptr > 31) {
-        wr_ptr = 0;  // 如果写指针超过31，重置为0
-      }
-      this->reg(REG_FIFO_WR_PTR) = wr_ptr;
-      num_samples=1;
-    } else {
-      return;  // 如果没有数据，直接返回
-    }
+    return;  // 如果没有数据，直接返回
   }
   uint8_t bytes_per_sample = this->active_leds_ * 3;  // 每个样本的字节数 = 激活LED数 * 3
-//  std::vector<uint8_t> data;
-//  for (int i = 0; i < num_samples * bytes_per_sample; i++) {
-//    data.push_back(this->reg(REG_FIFO_DATA).get());
-//  }
-  this->write(&REG_FIFO_DATA, 1); // burst read
-  uint8_t *data = new uint8_t[num_samples * bytes_per_sample];  // 最多32个样本，每个样本12个字节
+  if (bytes_per_sample == 0) {
+    return;
+  }
+  uint8_t *data = this->fifo_raw_.data();  // 静态缓冲区，最多32个样本，每个样本12个字节
+  this->write(&REG_FIFO_DATA, 1);         // burst read
   this->read(data, num_samples * bytes_per_sample);
 
-  MAX30105_RESOLUTION res = (MAX30105_RESOLUTION)(this->reg(REG_SPO2_CONFIG).get() & 0x03);  // 获取分辨率
-  uint8_t bit;
-  if (res == MAX30105_RESOLUTION_15_BIT) {
-    bit = 3;
-  } else if (res == MAX30105_RESOLUTION_16_BIT) {
-    bit = 2;
-  } else if (res == MAX30105_RESOLUTION_17_BIT) {
-    bit = 1;
-  } else {
-    bit = 0;
-  }
-  int index = ((int) num_samples - 1) * ((int) bytes_per_sample);  // 只要最后一个sample
-  uint32_t sample = 0;
+  // 分辨率取自寄存器影子，不再每次回读SPO2_CONFIG
+  uint8_t bit = 3 - (this->shadow_[REG_SPO2_CONFIG] & 0x03);
+  // 所有样本都入环形缓冲区，时间戳以读取时刻为最新样本，按采样周期向前插值
+  uint32_t now = micros();
+  uint32_t period = this->get_sample_period_us();
+  MAX30105Sample sample{};
+  // 与接近模式一致：红外计数的高8位超过PROX_INT_THRESH视为目标仍在
+  uint8_t presence_slot = this->active_leds_ >= 2 ? 1 : 0;
+  uint32_t presence_level = ((uint32_t) this->shadow_[REG_PROX_INT_THRESH] << 10) >> bit;
+  for (uint8_t n = 0; n < num_samples; n++) {
+    sample.timestamp = now - (uint32_t) (num_samples - 1 - n) * period;
+    decode_fifo_sample(data + n * bytes_per_sample, this->active_leds_, bit, sample);
+    if (this->temp_comp_enabled_) {
+      for (uint8_t i = 0; i < this->active_leds_; i++) {
+        sample.led[i] = (uint32_t) (sample.led[i] * this->temp_comp_gains_[i] + 0.5f);
+      }
+    }
+    this->push_sample_(sample);
+    if (sample.led[presence_slot] >= presence_level) {
+      this->last_presence_ = millis();
+    }
+    if (this->ppg_enabled_()) {
+      if (this->active_leds_ >= 2) {
+        this->ppg_.process(sample.led[1], sample.led[0]);
+      } else {
+        this->ppg_.process(sample.led[0], NAN);  // 仅红光模式只能测心率
+      }
+    }
+  }
+
+  if (this->stream_enabled_) {
+    this->stream_samples_();
+  }
+
+  // 传感器只发布最后一个样本
+  sensor::Sensor *led_sensors[MAX30105_MAX_LEDS] = {this->led1_sensor_, this->led2_sensor_, this->led3_sensor_,
+                                                    this->led4_sensor_};
   for (int i = 0; i < this->active_leds_; i++) {
-    sample = (((uint32_t) data[index + i * 3]) << 16) | (((uint32_t) data[index + i * 3 + 1]) << 8) |
-             (((uint32_t) data[index + i * 3 + 2]));  // 每个LED占3个字节
-    if (i == 0 && this->led1_sensor_ != nullptr) {
-      this->led1_sensor_->publish_state(sample >> bit);  // 发布LED1数据
-    } else if (i == 1 && this->led2_sensor_ != nullptr) {
-      this->led2_sensor_->publish_state(sample >> bit);  // 发布LED2数据
-    } else if (i == 2 && this->led3_sensor_ != nullptr) {
-      this->led3_sensor_->publish_state(sample >> bit);  // 发布LED3数据
-    } else if (i == 3 && this->led4_sensor_ != nullptr) {
-      this->led4_sensor_->publish_state(sample >> bit);  // 发布LED4数据
+    if (led_sensors[i] != nullptr) {
+      led_sensors[i]->publish_state(sample.led[i]);
+    }
+  }
+}
+
+void MAX30105Component::push_sample_(const MAX30105Sample &sample) {
+  this->sample_buffer_[this->sample_count_ % MAX30105_SAMPLE_BUFFER_SIZE] = sample;
+  this->sample_count_++;
+}
+
+void MAX30105Component::enter_idle_() {
+  // 重写MODE_CONFIG让芯片回到接近模式，只用导光LED(PILOT_PA)采样红外，直到PROX_INT
+  ESP_LOGD(TAG, "No target for %u ms, entering proximity mode", (unsigned) this->absence_timeout_);
+  this->power_state_ = MAX30105_POWER_IDLE;
+  this->set_mode_reg(this->mode_);
+  this->clear_fifo();
+  this->ppg_.reset();
+}
+
+void MAX30105Component::enter_active_() {
+  // 芯片在PROX_INT时已自动切换到正常采集，这里只同步状态
+  if (this->power_state_ != MAX30105_POWER_ACTIVE) {
+    ESP_LOGD(TAG, "Target detected, starting acquisition");
+  }
+  this->power_state_ = MAX30105_POWER_ACTIVE;
+  this->last_presence_ = millis();
+}
+
+void MAX30105Component::run_agc_() {
+  uint32_t count = this->sample_count_ - this->agc_sample_index_;
+  this->agc_sample_index_ = this->sample_count_;
+  bool range_up = this->agc_alc_overflow_;
+  this->agc_alc_overflow_ = false;
+  if (count == 0 && !range_up) {
+    return;
+  }
+  if (count > MAX30105_SAMPLE_BUFFER_SIZE) {
+    count = MAX30105_SAMPLE_BUFFER_SIZE;
+  }
+  // 时隙1~3依次对应LED1~LED3的PA寄存器
+  uint8_t leds = std::min<uint8_t>(this->active_leds_, 3);
+  float full_scale = 0x03FFFF >> (3 - (this->shadow_[REG_SPO2_CONFIG] & 0x03));
+  float target = (this->agc_low_ + this->agc_high_) / 2.0f;
+  uint8_t pa[3];
+  bool pa_changed = false;
+  bool range_down = leds > 0 && count > 0;
+  for (uint8_t i = 0; i < leds; i++) {
+    pa[i] = this->shadow_[REG_LED1_PA + i];
+    if (count == 0) {
+      range_down = false;
+      continue;
+    }
+    float sum = 0.0f;
+    for (uint32_t n = 1; n <= count; n++) {
+      sum += this->sample_buffer_[(this->sample_count_ - n) % MAX30105_SAMPLE_BUFFER_SIZE].led[i];
+    }
+    float level = sum / count / full_scale;
+    bool too_low = level < this->agc_low_;
+    if (!too_low || pa[i] < this->agc_max_current_) {
+      range_down = false;
+    }
+    if (level < AGC_NO_TARGET_LEVEL) {
+      continue;  // 没有目标时不加大电流，白白耗电
+    }
+    // 只有超出[low, high]才调整（滞回），按比例拉回到中间值
+    uint32_t wanted = pa[i];
+    if (level > this->agc_high_) {
+      if (pa[i] <= this->agc_min_current_) {
+        range_up = true;  // 电流已到下限仍饱和，只能加大量程
+        continue;
+      }
+      wanted = std::max<uint32_t>(pa[i] * target / level, this->agc_min_current_);
+    } else if (too_low) {
+      wanted = std::min<uint32_t>(std::max<uint32_t>(pa[i] * target / level, pa[i] + 1), this->agc_max_current_);
+    }
+    if (wanted != pa[i]) {
+      pa[i] = wanted;
+      pa_changed = true;
+    }
+  }
+
+  uint8_t range = (this->shadow_[REG_SPO2_CONFIG] >> 5) & 0x03;
+  uint8_t new_range = range;
+  if (range_up && range < MAX30105_ADC_RANGE_16384) {
+    new_range = range + 1;
+  } else if (!range_up && range_down && range > MAX30105_ADC_RANGE_2048) {
+    new_range = range - 1;  // 电流已到上限仍太暗，减小量程提高灵敏度
+  }
+  if (new_range != range) {
+    // 量程翻倍计数减半，本轮不再调电流，等下一轮数据
+    ESP_LOGD(TAG, "AGC: ADC range %u -> %u", 2048u << range, 2048u << new_range);
+    this->write_reg_(REG_SPO2_CONFIG, (this->shadow_[REG_SPO2_CONFIG] & ~0x60) | (new_range << 5));
+    this->adc_range_ = static_cast<MAX30105_ADC_RANGE>(new_range);
+    this->ppg_.rebase();
+    return;
+  }
+  if (pa_changed) {
+    ESP_LOGD(TAG, "AGC: LED current %u/%u/%u", pa[0], leds > 1 ? pa[1] : 0, leds > 2 ? pa[2] : 0);
+    this->write_regs_(REG_LED1_PA, pa, leds);
+    // 配置成员与芯片保持一致，dump_config等读到的是当前值
+    uint8_t *currents[3] = {&this->red_current_, &this->ir_current_, &this->green_current_};
+    for (uint8_t i = 0; i < leds; i++) {
+      *currents[i] = pa[i];
+    }
+    this->ppg_.rebase();
+  }
+}
+
+void MAX30105Component::stream_samples_() {
+  // 消费者来不及时缓冲区里最旧的样本已被覆盖，跳过这部分，接收端靠序号和时间戳发现缺口
+  if (this->sample_count_ - this->stream_index_ > MAX30105_SAMPLE_BUFFER_SIZE) {
+    this->stream_index_ = this->sample_count_ - MAX30105_SAMPLE_BUFFER_SIZE;
+  }
+  while (this->sample_count_ - this->stream_index_ >= this->stream_samples_per_frame_) {
+    this->build_stream_frame_(this->stream_index_);
+    this->stream_index_ += this->stream_samples_per_frame_;
+    this->on_stream_frame_callback_.call(this->stream_frame_);
+  }
+}
+
+static void put_u32(std::vector<uint8_t> &frame, uint32_t value) {
+  for (uint8_t i = 0; i < 4; i++) {
+    frame.push_back((value >> (i * 8)) & 0xFF);
+  }
+}
+
+void MAX30105Component::build_stream_frame_(uint32_t first) {
+  std::vector<uint8_t> &frame = this->stream_frame_;
+  frame.clear();  // 不释放容量，不会重新分配
+  frame.push_back(MAX30105_STREAM_MAGIC);
+  frame.push_back(this->stream_sequence_ & 0xFF);
+  frame.push_back(this->stream_sequence_ >> 8);
+  frame.push_back(this->active_leds_);
+  frame.push_back(this->stream_samples_per_frame_);
+  put_u32(frame, this->sample_buffer_[first % MAX30105_SAMPLE_BUFFER_SIZE].timestamp);
+  put_u32(frame, this->get_sample_period_us());
+  this->stream_sequence_++;
+
+  std::array<uint32_t, MAX30105_MAX_LEDS> prev{};
+  for (uint8_t n = 0; n < this->stream_samples_per_frame_; n++) {
+    const MAX30105Sample &sample = this->sample_buffer_[(first + n) % MAX30105_SAMPLE_BUFFER_SIZE];
+    for (uint8_t i = 0; i < this->active_leds_; i++) {
+      uint32_t value = std::min(sample.led[i], MAX30105_STREAM_SAMPLE_MAX);
+      if (n == 0) {
+        frame.push_back(value & 0xFF);
+        frame.push_back((value >> 8) & 0xFF);
+        frame.push_back((value >> 16) & 0xFF);
+        prev[i] = value;
+        continue;
+      }
+      // 相邻样本差分很小，zigzag后用varint，通常1~2字节
+      int32_t delta = (int32_t) value - (int32_t) prev[i];
+      prev[i] = value;
+      uint32_t zigzag = ((uint32_t) delta << 1) ^ (uint32_t) (delta >> 31);
+      while (zigzag >= 0x80) {
+        frame.push_back((zigzag & 0x7F) | 0x80);
+        zigzag >>= 7;
+      }
+      frame.push_back(zigzag);
     }
   }
-  delete[] data;
-  //  std::vector<std::vector<uint32_t>> samples;
+}
+
+void MAX30105Component::publish_ppg_() {
+  if (this->heart_rate_sensor_ != nullptr) {
+    this->heart_rate_sensor_->publish_state(this->ppg_.get_heart_rate());
+  }
+  if (this->spo2_sensor_ != nullptr) {
+    this->spo2_sensor_->publish_state(this->ppg_.get_spo2());
+  }
+  if (this->signal_quality_sensor_ != nullptr) {
+    this->signal_quality_sensor_->publish_state(this->ppg_.get_signal_quality());
+  }
+}
+
+uint32_t MAX30105Component::get_sample_period_us() const {
+  return fifo_sample_period_us(this->sample_rate_, this->sample_avg_);
 }
 
 void MAX30105Component::read_overflow_counter() {
@@ -194,9 +427,17 @@ void MAX30105Component::read_overflow_counter() {
 }
 
 
-void MAX30105Component::set_proximity_threshold_reg(uint8_t threshold) { this->reg(REG_PROX_INT_THRESH) = threshold; }
+void MAX30105Component::set_proximity_threshold_reg(uint8_t threshold) {
+  this->write_reg_(REG_PROX_INT_THRESH, threshold);
+}
 
-void MAX30105Component::read_temperature() { this->set_bit(REG_TEMP_CONFIG, 0); }
+void MAX30105Component::read_temperature() {
+  this->reg(REG_TEMP_CONFIG) = 0x01;  // TEMP_EN自动清零，不进影子
+  if (this->interrupt_pin_ == nullptr || !(this->shadow_[REG_INTR_ENABLE_2] & MAX30105_INTERRUPT_TEMP_RDY)) {
+    // 收不到TEMP_RDY中断时，等转换完成（约29ms）后直接读结果
+    this->set_timeout("temperature", 50, [this]() { this->read_temperature_result_(); });
+  }
+}
 
 void MAX30105Component::enable_interrupts(bool fifo_almost_full, bool data_ready, bool alc_overflow, bool prox_int,
                                           bool temp_ready) {
@@ -217,8 +458,9 @@ void MAX30105Component::enable_interrupts(bool fifo_almost_full, bool data_ready
   if (temp_ready) {
     intr_en2 |= MAX30105_INTERRUPT_TEMP_RDY;
   }
-  this->reg(REG_INTR_ENABLE_1) = intr_en1;
-  this->reg(REG_INTR_ENABLE_2) = intr_en2;  // 设置第二个寄存器
+  uint8_t intr_en[2] = {intr_en1, intr_en2};
+  this->write_regs_(REG_INTR_ENABLE_1, intr_en, 2);  // 两个使能寄存器连续写
+  this->set_interrupts(fifo_almost_full, data_ready, alc_overflow, prox_int, temp_ready);  // 运行时修改也要同步FIFO读取方式
 }
 
 void MAX30105Component::set_multi_led_slots_reg(std::vector<uint8_t>& slots) {
@@ -237,23 +479,25 @@ void MAX30105Component::set_multi_led_slots_reg(std::vector<uint8_t>& slots) {
   if (size > 3) {
     reg12 |= (slots[3] << 4);
   }
-  this->reg(REG_MULTI_LED_CTRL1) = reg11;  // 设置第一个寄存器
-  this->reg(REG_MULTI_LED_CTRL2) = reg12;  // 设置第二个寄存器
+  uint8_t ctrl[2] = {reg11, reg12};
+  this->write_regs_(REG_MULTI_LED_CTRL1, ctrl, 2);
 }
 
 void MAX30105Component::set_led_current_reg(uint8_t red_current, uint8_t ir_current, uint8_t green_current,
                                             uint8_t pilot_current) {
   // 设置LED电流寄存器
-  this->reg(REG_LED1_PA) = red_current;
-  this->reg(REG_LED2_PA) = ir_current;
-  this->reg(REG_LED3_PA) = green_current;
-  this->reg(REG_PILOT_PA) = pilot_current;
+  uint8_t pa[3] = {red_current, ir_current, green_current};
+  this->write_regs_(REG_LED1_PA, pa, 3);  // LED1~LED3地址连续
+  this->write_reg_(REG_PILOT_PA, pilot_current);
+  this->red_current_ = red_current;
+  this->ir_current_ = ir_current;
+  this->green_current_ = green_current;
+  this->pilot_current_ = pilot_current;
 }
 
 void MAX30105Component::set_mode_reg(MAX30105_MODE mode) {
-  uint8_t current = this->reg(REG_MODE_CONFIG).get();
-  uint8_t new_config = (current & 0xF8) | mode;
-  this->reg(REG_MODE_CONFIG) = new_config;
+  uint8_t new_config = (this->shadow_[REG_MODE_CONFIG] & 0xF8) | mode;
+  this->write_reg_(REG_MODE_CONFIG, new_config);
 }
 
 bool MAX30105Component::verify_part_id() {
@@ -266,18 +510,28 @@ bool MAX30105Component::verify_part_id() {
 }
 
 void MAX30105Component::reset() {
-  this->set_bit(REG_MODE_CONFIG, 6);  // 设置MODE_CONFIG寄存器的第6位为1以复位
+  this->reg(REG_MODE_CONFIG) = this->shadow_[REG_MODE_CONFIG] | (1 << 6);  // 设置MODE_CONFIG寄存器的第6位为1以复位
+  this->shadow_.fill(0);  // 复位后所有配置寄存器回到上电默认值0
 }
 
 void MAX30105Component::set_bit(uint8_t addr, uint8_t bit) {
-  uint8_t value = this->reg(addr).get();
-  value |= (1 << bit);     // 设置指定的位
-  this->reg(addr) = value;  // 写回寄存器
+  this->write_reg_(addr, this->shadow_[addr] | (1 << bit));  // 基于影子修改，省掉一次读
 }
 
 void MAX30105Component::clear_bit(uint8_t addr, uint8_t bit) {
-  uint8_t value = this->reg(addr).get();
-  this->reg(addr) = value & ~(1 << bit);  // 写回寄存器
+  this->write_reg_(addr, this->shadow_[addr] & ~(1 << bit));
+}
+
+void MAX30105Component::write_reg_(uint8_t addr, uint8_t value) {
+  this->reg(addr) = value;
+  this->shadow_[addr] = value;
+}
+
+void MAX30105Component::write_regs_(uint8_t addr, const uint8_t *values, uint8_t len) {
+  this->write_register(addr, values, len);
+  for (uint8_t i = 0; i < len; i++) {
+    this->shadow_[addr + i] = values[i];
+  }
 }
 
 void MAX30105Component::shutdown() {
@@ -289,85 +543,96 @@ void MAX30105Component::wakeup() {
 }
 
 void MAX30105Component::clear_fifo() {
-  this->reg(REG_FIFO_WR_PTR) = 0;  // 清除FIFO写指针
-  this->reg(REG_OVF_COUNTER) = 0;  // 清除溢出计数器
-  this->reg(REG_FIFO_RD_PTR) = 0;  // 清除FIFO读指针
+  const uint8_t zeros[3] = {0, 0, 0};
+  this->write_register(REG_FIFO_WR_PTR, zeros, 3);  // 清除写指针、溢出计数器、读指针
 }
 
 void MAX30105Component::loop() {
-  if (this->interrupt_) {
-    uint8_t status1 = this->reg(REG_INTR_STATUS_1).get();  // 读取中断状态寄存器以清除中断
-    uint8_t status2 = this->reg(REG_INTR_STATUS_2).get();  // 读取中断状态寄存器以清除中断
-    if (status1 & MAX30105_INTERRUPT_PWR_RDY) {
-      if (this->power_ready_binary_sensor_ != nullptr) {
-        this->power_ready_binary_sensor_->publish_state(true);
-      }
-      this->on_power_ready_callback_.call();
-    }
-    if (status1 & MAX30105_INTERRUPT_PROXIMITY) {
-      if (this->target_binary_sensor_ != nullptr) {
-        this->target_binary_sensor_->publish_state(true);
-      }
-      this->on_prox_int_callback_.call();
-    }
-    if (status1 & MAX30105_INTERRUPT_ALC_OVF) {
-      if (this->alc_overflow_binary_sensor_ != nullptr) {
-        this->alc_overflow_binary_sensor_->publish_state(true);
-      }
-      this->on_alc_overflow_callback_.call();
-    }
-    if (status1 & MAX30105_INTERRUPT_DATA_RDY) {
-      if (this->data_ready_binary_sensor_ != nullptr) {
-        this->data_ready_binary_sensor_->publish_state(true);
-      }
-      this->on_data_ready_callback_.call();
-    }
-    if (status1 & MAX30105_INTERRUPT_FIFO_FULL) {
-      if (this->fifo_full_binary_sensor_ != nullptr) {
-        this->fifo_full_binary_sensor_->publish_state(true);
-      }
-      this->read_overflow_counter();
-      this->on_fifo_almost_full_callback_.call();
-    }
-    if (status2 & MAX30105_INTERRUPT_TEMP_RDY) {
-      if (this->temperature_ready_binary_sensor_ != nullptr) {
-        this->temperature_ready_binary_sensor_->publish_state(true);
-      }
-      int32_t temp_int = (int32_t)this->reg(REG_TEMP_INT).get();
-      uint8_t temp_frac = this->reg(REG_TEMP_FRAC).get(); // & 0x0F;  // 只保留低4位
-      if (temp_int > 127) {
-        temp_int -= 256;
-      }
-      float temperature = (float) temp_int + ((float) temp_frac) * 0.0625;
-      if (this->temperature_sensor_ != nullptr) {
-        this->temperature_sensor_->publish_state(temperature);
-      }
-      this->on_temp_ready_callback_.call(temperature);
-    }
-    this->interrupt_ = false;
-    this->need_clear_ = true;
+  if (!this->interrupt_) {
     return;
   }
-  if (this->need_clear_) {
-    if (this->power_ready_binary_sensor_ != nullptr) {
-      this->power_ready_binary_sensor_->publish_state(false);
-    }
-    if (this->target_binary_sensor_ != nullptr) {
-      this->target_binary_sensor_->publish_state(false);
-    }
-    if (this->alc_overflow_binary_sensor_ != nullptr) {
-      this->alc_overflow_binary_sensor_->publish_state(false);
+  this->interrupt_ = false;  // 先清标志，读状态期间再来的中断不会丢
+  uint8_t status[2] = {0, 0};
+  this->read_register(REG_INTR_STATUS_1, status, 2);  // 一次读出两个状态寄存器以清除中断
+  uint8_t status1 = status[0];
+  uint8_t status2 = status[1];
+  if (status1 & MAX30105_INTERRUPT_PWR_RDY) {
+    this->record_event_(MAX30105_EVENT_POWER_READY);
+    this->on_power_ready_callback_.call();
+  }
+  if (status1 & MAX30105_INTERRUPT_PROXIMITY) {
+    this->record_event_(MAX30105_EVENT_PROXIMITY);
+    if (this->proximity_gating_) {
+      this->enter_active_();
     }
-    if (this->data_ready_binary_sensor_ != nullptr) {
-      this->data_ready_binary_sensor_->publish_state(false);
+    this->on_prox_int_callback_.call();
+  }
+  if (status1 & MAX30105_INTERRUPT_ALC_OVF) {
+    this->record_event_(MAX30105_EVENT_ALC_OVERFLOW);
+    this->agc_alc_overflow_ = true;  // 环境光抵消溢出，下次AGC时加大ADC量程
+    this->on_alc_overflow_callback_.call();
+  }
+  if (status1 & MAX30105_INTERRUPT_DATA_RDY) {
+    this->record_event_(MAX30105_EVENT_DATA_READY);
+    this->on_data_ready_callback_.call();
+  }
+  if (status1 & MAX30105_INTERRUPT_FIFO_FULL) {
+    this->record_event_(MAX30105_EVENT_FIFO_FULL);
+    this->read_fifo();  // 由硬件节奏驱动FIFO读取
+    this->on_fifo_almost_full_callback_.call();
+  }
+  if (status2 & MAX30105_INTERRUPT_TEMP_RDY) {
+    this->record_event_(MAX30105_EVENT_TEMP_READY);
+    this->read_temperature_result_();
+  }
+}
+
+void MAX30105Component::read_temperature_result_() {
+  uint8_t temp[2] = {0, 0};
+  this->read_register(REG_TEMP_INT, temp, 2);  // TEMP_INT、TEMP_FRAC连续读
+  int32_t temp_int = (int32_t) temp[0];
+  uint8_t temp_frac = temp[1] & 0x0F;  // 只保留低4位
+  if (temp_int > 127) {
+    temp_int -= 256;
+  }
+  float temperature = (float) temp_int + ((float) temp_frac) * 0.0625;
+  if (this->temp_comp_enabled_) {
+    // 每个LED：counts(T) = counts(Tref) * (1 + k * (T - Tref))，FIFO样本乘以倒数拉回参考温度
+    for (uint8_t i = 0; i < MAX30105_MAX_LEDS; i++) {
+      float drift = 1.0f + this->temp_comp_coefficients_[i] * (temperature - this->temp_comp_reference_);
+      this->temp_comp_gains_[i] = drift > 0.1f ? 1.0f / drift : 1.0f;
     }
-    if (this->fifo_full_binary_sensor_ != nullptr) {
-      this->fifo_full_binary_sensor_->publish_state(false);
+  }
+  if (this->temperature_sensor_ != nullptr) {
+    this->temperature_sensor_->publish_state(temperature);
+  }
+  this->on_temp_ready_callback_.call(temperature);
+}
+
+void MAX30105Component::record_event_(MAX30105_EVENT event) {
+  this->event_counts_[event]++;
+  // 只在状态从false变为true时发布，回落由publish_events_按窗口处理
+  binary_sensor::BinarySensor *binary_sensor = this->event_binary_sensors_[event];
+  if (binary_sensor != nullptr && !this->event_states_[event]) {
+    this->event_states_[event] = true;
+    binary_sensor->publish_state(true);
+  }
+}
+
+void MAX30105Component::publish_events_() {
+  // 每个update周期为一个统计窗口：计数传感器发布窗口内事件数，窗口内没有事件的二值传感器回落为false
+  for (uint8_t event = 0; event < MAX30105_EVENT_COUNT; event++) {
+    uint32_t count = this->event_counts_[event];
+    this->event_counts_[event] = 0;
+    if (this->event_count_sensors_[event] != nullptr) {
+      this->event_count_sensors_[event]->publish_state(count);
     }
-    if (this->temperature_ready_binary_sensor_ != nullptr) {
-      this->temperature_ready_binary_sensor_->publish_state(false);
+    bool active = count > 0;
+    binary_sensor::BinarySensor *binary_sensor = this->event_binary_sensors_[event];
+    if (binary_sensor != nullptr && this->event_states_[event] != active) {
+      this->event_states_[event] = active;
+      binary_sensor->publish_state(active);
     }
-    this->need_clear_ = false;
   }
 }
 
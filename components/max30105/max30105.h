@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <vector>
 #include "esphome/components/i2c/i2c.h"
 #include "esphome/components/sensor/sensor.h"
@@ -7,6 +9,8 @@
 #include "esphome/core/automation.h"
 #include "esphome/core/component.h"
 #include "esphome/core/hal.h"
+#include "fifo.h"
+#include "ppg_processor.h"
 
 namespace esphome {
 namespace max30105 {
@@ -71,6 +75,37 @@ enum MAX30105_INTERRUPT : uint8_t {
   MAX30105_INTERRUPT_TEMP_RDY = 0x02,   // 温度就绪 (0x01 bit1)
 };
 
+// 中断事件，用于二值传感器和事件计数传感器的下标
+enum MAX30105_EVENT : uint8_t {
+  MAX30105_EVENT_POWER_READY = 0,
+  MAX30105_EVENT_PROXIMITY,
+  MAX30105_EVENT_ALC_OVERFLOW,
+  MAX30105_EVENT_DATA_READY,
+  MAX30105_EVENT_FIFO_FULL,
+  MAX30105_EVENT_TEMP_READY,
+  MAX30105_EVENT_COUNT,
+};
+
+// 接近门控的电源状态
+enum MAX30105_POWER_STATE : uint8_t {
+  MAX30105_POWER_IDLE = 0,    // 接近模式，只有导光LED工作
+  MAX30105_POWER_ACTIVE = 1,  // 正常多LED采集
+};
+
+static const uint16_t MAX30105_SAMPLE_BUFFER_SIZE = 256;  // 样本环形缓冲区容量
+static const uint8_t MAX30105_SHADOW_SIZE = 0x31;         // 寄存器影子覆盖0x00~0x30
+
+// 二进制数据流帧（小端）：
+//   u8 magic | u16 序号 | u8 LED数 | u8 样本数 | u32 首样本时间戳(us) | u32 样本周期(us)
+//   首样本各LED 3字节值（同样小端），之后每个样本各LED相对上一样本的zigzag varint差分
+//   所有样本值限幅到18位（温度补偿后可能超出），差分最多3字节，帧长不超过MAX_FRAME_SIZE
+static const uint8_t MAX30105_STREAM_MAGIC = 0xA5;
+static const uint32_t MAX30105_STREAM_SAMPLE_MAX = 0x03FFFF;
+static const uint8_t MAX30105_STREAM_HEADER_SIZE = 13;
+static const uint8_t MAX30105_STREAM_MAX_SAMPLES = 32;
+static const uint16_t MAX30105_STREAM_MAX_FRAME_SIZE =
+    MAX30105_STREAM_HEADER_SIZE + MAX30105_STREAM_MAX_SAMPLES * MAX30105_MAX_LEDS * 3;
+
 class MAX30105Component : public PollingComponent, public i2c::I2CDevice {
  public:
   float get_setup_priority() const override { return setup_priority::DATA; }
@@ -93,24 +128,33 @@ class MAX30105Component : public PollingComponent, public i2c::I2CDevice {
   void set_rd_ptr_sensor(sensor::Sensor *rd_ptr_sensor) {
     this->rd_ptr_sensor_ = rd_ptr_sensor;
   }
+  void set_heart_rate_sensor(sensor::Sensor *heart_rate_sensor) { this->heart_rate_sensor_ = heart_rate_sensor; }
+  void set_spo2_sensor(sensor::Sensor *spo2_sensor) { this->spo2_sensor_ = spo2_sensor; }
+  void set_signal_quality_sensor(sensor::Sensor *signal_quality_sensor) {
+    this->signal_quality_sensor_ = signal_quality_sensor;
+  }
   // binary sensors
   void set_power_ready_binary_sensor(binary_sensor::BinarySensor *power_ready_binary_sensor) {
-    this->power_ready_binary_sensor_ = power_ready_binary_sensor;
+    this->event_binary_sensors_[MAX30105_EVENT_POWER_READY] = power_ready_binary_sensor;
   }
   void set_target_binary_sensor(binary_sensor::BinarySensor *target_binary_sensor) {
-    this->target_binary_sensor_ = target_binary_sensor;
+    this->event_binary_sensors_[MAX30105_EVENT_PROXIMITY] = target_binary_sensor;
   }
   void set_alc_overflow_binary_sensor(binary_sensor::BinarySensor *alc_overflow_binary_sensor) {
-    this->alc_overflow_binary_sensor_ = alc_overflow_binary_sensor;
+    this->event_binary_sensors_[MAX30105_EVENT_ALC_OVERFLOW] = alc_overflow_binary_sensor;
   }
   void set_data_ready_binary_sensor(binary_sensor::BinarySensor *data_ready_binary_sensor) {
-    this->data_ready_binary_sensor_ = data_ready_binary_sensor;
+    this->event_binary_sensors_[MAX30105_EVENT_DATA_READY] = data_ready_binary_sensor;
   }
   void set_fifo_full_binary_sensor(binary_sensor::BinarySensor *fifo_full_binary_sensor) {
-    this->fifo_full_binary_sensor_ = fifo_full_binary_sensor;
+    this->event_binary_sensors_[MAX30105_EVENT_FIFO_FULL] = fifo_full_binary_sensor;
   }
   void set_temperature_ready_binary_sensor(binary_sensor::BinarySensor *temperature_ready_binary_sensor) {
-    this->temperature_ready_binary_sensor_ = temperature_ready_binary_sensor;
+    this->event_binary_sensors_[MAX30105_EVENT_TEMP_READY] = temperature_ready_binary_sensor;
+  }
+  // 每个update周期内的中断事件数
+  void set_event_count_sensor(MAX30105_EVENT event, sensor::Sensor *event_count_sensor) {
+    this->event_count_sensors_[event] = event_count_sensor;
   }
 
   void set_mode(MAX30105_MODE mode) { this->mode_ = mode; }
@@ -136,6 +180,26 @@ class MAX30105Component : public PollingComponent, public i2c::I2CDevice {
   }
   void set_proximity_threshold(uint8_t threshold) { this->proximity_threshold_ = threshold; }
   void set_interrupt_pin(InternalGPIOPin *pin) { this->interrupt_pin_ = pin; }
+  void set_proximity_gating(bool proximity_gating) { this->proximity_gating_ = proximity_gating; }
+  void set_absence_timeout(uint32_t absence_timeout) { this->absence_timeout_ = absence_timeout; }
+  void set_stream_samples_per_frame(uint8_t samples) { this->stream_samples_per_frame_ = samples; }
+  void set_temperature_interval(uint32_t temperature_interval) { this->temperature_interval_ = temperature_interval; }
+  // 温度补偿：coefficient为每摄氏度的相对漂移（0.01即1%/°C），按时隙顺序对应LED1~LED4
+  void set_temperature_reference(float reference) {
+    this->temp_comp_enabled_ = true;
+    this->temp_comp_reference_ = reference;
+  }
+  void set_temperature_coefficient(uint8_t led, float coefficient) {
+    this->temp_comp_coefficients_[led] = coefficient;
+  }
+  MAX30105_POWER_STATE get_power_state() const { return this->power_state_; }
+  void set_auto_gain(float low, float high, uint8_t min_current, uint8_t max_current) {
+    this->agc_enabled_ = true;
+    this->agc_low_ = low;
+    this->agc_high_ = high;
+    this->agc_min_current_ = min_current;
+    this->agc_max_current_ = max_current;
+  }
   // automation call
   void reset();
   void shutdown();
@@ -145,6 +209,15 @@ class MAX30105Component : public PollingComponent, public i2c::I2CDevice {
   void set_led_current_reg(uint8_t red_current, uint8_t ir_current, uint8_t green_current, uint8_t pilot_current);
   void enable_interrupts(bool fifo_almost_full, bool data_ready, bool alc_overflow, bool prox_int, bool temp_ready);
   void simulate_interrupt();
+  // 样本缓冲区，供下游（滤波、心率血氧、数据流）读取
+  // sample_count为累计写入的样本数，第n个样本位于 buffer[n % MAX30105_SAMPLE_BUFFER_SIZE]
+  const std::array<MAX30105Sample, MAX30105_SAMPLE_BUFFER_SIZE> &get_sample_buffer() const {
+    return this->sample_buffer_;
+  }
+  uint32_t get_sample_count() const { return this->sample_count_; }
+  uint8_t get_active_leds() const { return this->active_leds_; }
+  uint32_t get_sample_period_us() const;
+
  protected:
   MAX30105_MODE mode_;
   MAX30105_ADC_RANGE adc_range_;
@@ -166,8 +239,23 @@ class MAX30105Component : public PollingComponent, public i2c::I2CDevice {
   bool prox_int_;
   bool temp_ready_;
   uint8_t proximity_threshold_;  // 接近阈值
-  bool interrupt_{false};        // 是否发生中断
-  bool need_clear_{false};       // 是否需要清除中断传感器
+  // 接近门控：空闲时芯片处于接近模式，PROX_INT后全速采集，目标离开absence_timeout_后回到空闲
+  bool proximity_gating_{false};
+  uint32_t absence_timeout_{10000};
+  uint32_t last_presence_{0};
+  MAX30105_POWER_STATE power_state_{MAX30105_POWER_ACTIVE};
+  void enter_idle_();
+  void enter_active_();
+  // 自动增益：按缓冲区内各LED的直流电平（占满量程比例）调整LED电流和ADC量程
+  bool agc_enabled_{false};
+  float agc_low_{0.25f};
+  float agc_high_{0.75f};
+  uint8_t agc_min_current_{0x05};
+  uint8_t agc_max_current_{0xFF};
+  uint32_t agc_sample_index_{0};
+  bool agc_alc_overflow_{false};
+  void run_agc_();
+  volatile bool interrupt_{false};  // 是否发生中断
 
   sensor::Sensor *temperature_sensor_{nullptr};
   sensor::Sensor *led1_sensor_{nullptr};
@@ -177,13 +265,16 @@ class MAX30105Component : public PollingComponent, public i2c::I2CDevice {
   sensor::Sensor *fifo_overflow_counter_sensor_{nullptr};
   sensor::Sensor *wr_ptr_sensor_{nullptr};
   sensor::Sensor *rd_ptr_sensor_{nullptr};
+  sensor::Sensor *heart_rate_sensor_{nullptr};
+  sensor::Sensor *spo2_sensor_{nullptr};
+  sensor::Sensor *signal_quality_sensor_{nullptr};
 
-  binary_sensor::BinarySensor *power_ready_binary_sensor_{nullptr};
-  binary_sensor::BinarySensor *target_binary_sensor_{nullptr};
-  binary_sensor::BinarySensor *alc_overflow_binary_sensor_{nullptr};
-  binary_sensor::BinarySensor *data_ready_binary_sensor_{nullptr};
-  binary_sensor::BinarySensor *fifo_full_binary_sensor_{nullptr};
-  binary_sensor::BinarySensor *temperature_ready_binary_sensor_{nullptr};
+  std::array<binary_sensor::BinarySensor *, MAX30105_EVENT_COUNT> event_binary_sensors_{};
+  std::array<sensor::Sensor *, MAX30105_EVENT_COUNT> event_count_sensors_{};
+  std::array<uint32_t, MAX30105_EVENT_COUNT> event_counts_{};  // 当前窗口内的事件数
+  std::array<bool, MAX30105_EVENT_COUNT> event_states_{};      // 二值传感器最后发布的状态
+  void record_event_(MAX30105_EVENT event);
+  void publish_events_();
 
   InternalGPIOPin *interrupt_pin_{nullptr};
 
@@ -192,11 +283,42 @@ class MAX30105Component : public PollingComponent, public i2c::I2CDevice {
   static void irq(MAX30105Component *c);
   void set_bit(uint8_t addr, uint8_t bit);
   void clear_bit(uint8_t addr, uint8_t bit);
+  // 配置寄存器写入时同步到影子，读改写和配置相关的计算都用影子，不再走I2C
+  void write_reg_(uint8_t addr, uint8_t value);
+  void write_regs_(uint8_t addr, const uint8_t *values, uint8_t len);
+  std::array<uint8_t, MAX30105_SHADOW_SIZE> shadow_{};
   void clear_fifo();
 
   void set_multi_led_slots_reg(std::vector<uint8_t>& slots);
   void read_temperature();
+  void read_temperature_result_();
+  uint32_t temperature_interval_{60000};
+  bool temp_comp_enabled_{false};
+  float temp_comp_reference_{25.0f};
+  std::array<float, MAX30105_MAX_LEDS> temp_comp_coefficients_{};
+  std::array<float, MAX30105_MAX_LEDS> temp_comp_gains_{1.0f, 1.0f, 1.0f, 1.0f};
   void read_fifo();
+  void push_sample_(const MAX30105Sample &sample);
+  // 配置了中断引脚并启用FIFO_A_FULL中断时，FIFO只在中断里读取
+  bool fifo_interrupt_driven_() const { return this->interrupt_pin_ != nullptr && this->fifo_almost_full_; }
+  std::array<uint8_t, MAX30105_FIFO_DEPTH * MAX30105_MAX_LEDS * 3> fifo_raw_{};
+  // 心率血氧处理，只有配置了对应传感器时才运行
+  bool ppg_enabled_() const {
+    return this->heart_rate_sensor_ != nullptr || this->spo2_sensor_ != nullptr ||
+           this->signal_quality_sensor_ != nullptr;
+  }
+  void publish_ppg_();
+  PPGProcessor ppg_;
+  // 数据流：凑满stream_samples_per_frame_个样本打一帧，帧缓冲只在setup时分配一次
+  bool stream_enabled_{false};
+  uint8_t stream_samples_per_frame_{16};
+  uint16_t stream_sequence_{0};
+  uint32_t stream_index_{0};  // 下一帧第一个样本的sample_count序号
+  std::vector<uint8_t> stream_frame_;
+  void stream_samples_();
+  void build_stream_frame_(uint32_t first);
+  std::array<MAX30105Sample, MAX30105_SAMPLE_BUFFER_SIZE> sample_buffer_{};
+  uint32_t sample_count_{0};
 
   void read_overflow_counter();
   // trigers
@@ -206,6 +328,7 @@ class MAX30105Component : public PollingComponent, public i2c::I2CDevice {
   friend class ALCOverflowTrigger;
   friend class ProximityInterruptTrigger;
   friend class TemperatureReadyTrigger;
+  friend class StreamFrameTrigger;
 
   CallbackManager<void()> on_power_ready_callback_;
   CallbackManager<void()> on_fifo_almost_full_callback_;
@@ -213,6 +336,7 @@ class MAX30105Component : public PollingComponent, public i2c::I2CDevice {
   CallbackManager<void()> on_alc_overflow_callback_;
   CallbackManager<void()> on_prox_int_callback_;
   CallbackManager<void(float)> on_temp_ready_callback_;
+  CallbackManager<void(const std::vector<uint8_t> &)> on_stream_frame_callback_;
 
   void add_on_power_ready_callback(std::function<void()> callback) {
     this->on_power_ready_callback_.add(std::move(callback));
@@ -232,8 +356,19 @@ class MAX30105Component : public PollingComponent, public i2c::I2CDevice {
   void add_on_temp_ready_callback(std::function<void(float)> callback) {
     this->on_temp_ready_callback_.add(std::move(callback));
   }
+  void add_on_stream_frame_callback(std::function<void(const std::vector<uint8_t> &)> callback) {
+    this->stream_enabled_ = true;
+    this->on_stream_frame_callback_.add(std::move(callback));
+  }
 };  // class MAX30105Component
 
+class StreamFrameTrigger : public Trigger<const std::vector<uint8_t> &> {
+ public:
+  explicit StreamFrameTrigger(MAX30105Component *parent) {
+    parent->add_on_stream_frame_callback(std::bind(&StreamFrameTrigger::trigger, this, std::placeholders::_1));
+  }
+};
+
 class PowerReadyTrigger : public Trigger<> {
  public:
   explicit PowerReadyTrigger(MAX30105Component *parent) {
@@ -0,0 +1,201 @@
+#include "ppg_processor.h"
+
+namespace esphome {
+namespace max30105 {
+
+static const float PPG_LOW_HZ = 0.5f;          // 30 bpm
+static const float PPG_HIGH_HZ = 4.0f;         // 240 bpm
+static const float PPG_REFRACTORY_S = 0.25f;   // 最高240 bpm
+static const float PPG_MAX_INTERVAL_S = 2.0f;  // 最低30 bpm
+static const float PPG_RATIO_SMOOTHING = 0.3f;
+
+void PPGBiquad::set_bandpass(float sample_rate, float low_hz, float high_hz) {
+  // RBJ cookbook带通（峰值增益0dB），中心频率取几何平均
+  float center = std::sqrt(low_hz * high_hz);
+  float q = center / (high_hz - low_hz);
+  float w0 = 2.0f * float(M_PI) * center / sample_rate;
+  float alpha = std::sin(w0) / (2.0f * q);
+  float a0 = 1.0f + alpha;
+  this->b0 = alpha / a0;
+  this->b1 = 0.0f;
+  this->b2 = -alpha / a0;
+  this->a1 = -2.0f * std::cos(w0) / a0;
+  this->a2 = (1.0f - alpha) / a0;
+  this->reset();
+}
+
+void PPGProcessor::configure(float sample_rate, uint32_t full_scale) {
+  this->sample_rate_ = sample_rate;
+  this->dc_alpha_ = 1.0f - std::exp(-1.0f / sample_rate);
+  this->threshold_decay_ = std::exp(-1.0f / sample_rate);
+  this->finger_threshold_ = full_scale / 32.0f;
+  this->refractory_ = (uint32_t) (PPG_REFRACTORY_S * sample_rate);
+  this->max_interval_ = (uint32_t) (PPG_MAX_INTERVAL_S * sample_rate);
+  this->ir_filter_.set_bandpass(sample_rate, PPG_LOW_HZ, PPG_HIGH_HZ);
+  this->red_filter_.set_bandpass(sample_rate, PPG_LOW_HZ, PPG_HIGH_HZ);
+  this->reset();
+}
+
+void PPGProcessor::reset() {
+  this->ir_filter_.reset();
+  this->red_filter_.reset();
+  this->ir_dc_ = NAN;
+  this->red_dc_ = NAN;
+  this->index_ = 0;
+  this->prev_ = 0.0f;
+  this->rising_ = false;
+  this->peak_level_ = 0.0f;
+  this->threshold_ = 0.0f;
+  this->has_last_beat_ = false;
+  this->interval_head_ = 0;
+  this->interval_count_ = 0;
+  this->ir_ac_sq_ = 0.0f;
+  this->red_ac_sq_ = 0.0f;
+  this->ac_count_ = 0;
+  this->ratio_ = NAN;
+}
+
+void PPGProcessor::rebase() {
+  this->ir_filter_.reset();
+  this->red_filter_.reset();
+  this->ir_dc_ = NAN;
+  this->red_dc_ = NAN;
+  this->prev_ = 0.0f;
+  this->rising_ = false;
+  // 跨越电平跳变的周期不能用来算R值
+  this->ir_ac_sq_ = 0.0f;
+  this->red_ac_sq_ = 0.0f;
+  this->ac_count_ = 0;
+}
+
+void PPGProcessor::process(float ir, float red) {
+  this->index_++;
+  // 去直流：指数滑动平均跟踪基线，直流值同时用于R值归一化
+  if (std::isnan(this->ir_dc_)) {
+    this->ir_dc_ = ir;
+  }
+  this->ir_dc_ += (ir - this->ir_dc_) * this->dc_alpha_;
+  float ir_ac = this->ir_filter_.apply(ir - this->ir_dc_);
+
+  bool has_red = !std::isnan(red);
+  float red_ac = 0.0f;
+  if (has_red) {
+    if (std::isnan(this->red_dc_)) {
+      this->red_dc_ = red;
+    }
+    this->red_dc_ += (red - this->red_dc_) * this->dc_alpha_;
+    red_ac = this->red_filter_.apply(red - this->red_dc_);
+  }
+  this->ir_ac_sq_ += ir_ac * ir_ac;
+  this->red_ac_sq_ += red_ac * red_ac;
+  this->ac_count_++;
+
+  if (this->ir_dc_ < this->finger_threshold_) {
+    // 没有手指，清掉心跳历史
+    this->has_last_beat_ = false;
+    this->interval_count_ = 0;
+    this->ratio_ = NAN;
+    return;
+  }
+
+  // 血液吸收使光强下降，取反后脉搏波峰对应收缩期
+  float s = -ir_ac;
+  this->threshold_ *= this->threshold_decay_;
+  if (s > this->prev_ && s > this->threshold_) {
+    this->rising_ = true;
+  } else if (this->rising_ && s < this->prev_) {
+    // 上一个样本是局部极大值
+    this->rising_ = false;
+    this->peak_level_ += (this->prev_ - this->peak_level_) * 0.25f;
+    this->threshold_ = this->peak_level_ * 0.5f;
+    this->on_peak_(this->index_ - 1);
+  }
+  this->prev_ = s;
+
+  if (this->has_last_beat_ && this->index_ - this->last_beat_ > this->max_interval_ * 2) {
+    // 太久没有心跳，之前的间隔不再可信
+    this->has_last_beat_ = false;
+    this->interval_count_ = 0;
+  }
+}
+
+void PPGProcessor::on_peak_(uint32_t index) {
+  if (this->has_last_beat_) {
+    uint32_t interval = index - this->last_beat_;
+    if (interval < this->refractory_) {
+      return;  // 重搏波或噪声，忽略
+    }
+    if (interval <= this->max_interval_) {
+      this->intervals_[this->interval_head_] = interval;
+      this->interval_head_ = (this->interval_head_ + 1) % PPG_MAX_INTERVALS;
+      if (this->interval_count_ < PPG_MAX_INTERVALS) {
+        this->interval_count_++;
+      }
+      // 一个完整心跳周期内的交流有效值比
+      if (this->ac_count_ > 0 && this->ir_ac_sq_ > 0.0f && this->red_ac_sq_ > 0.0f && this->red_dc_ > 0.0f) {
+        float ir_rms = std::sqrt(this->ir_ac_sq_ / this->ac_count_);
+        float red_rms = std::sqrt(this->red_ac_sq_ / this->ac_count_);
+        float ratio = (red_rms / this->red_dc_) / (ir_rms / this->ir_dc_);
+        if (std::isnan(this->ratio_)) {
+          this->ratio_ = ratio;
+        } else {
+          this->ratio_ += (ratio - this->ratio_) * PPG_RATIO_SMOOTHING;
+        }
+      }
+    }
+  }
+  this->has_last_beat_ = true;
+  this->last_beat_ = index;
+  this->ir_ac_sq_ = 0.0f;
+  this->red_ac_sq_ = 0.0f;
+  this->ac_count_ = 0;
+}
+
+float PPGProcessor::get_heart_rate() const {
+  if (this->interval_count_ < 3) {
+    return NAN;
+  }
+  uint32_t sum = 0;
+  for (uint8_t i = 0; i < this->interval_count_; i++) {
+    sum += this->intervals_[i];
+  }
+  return 60.0f * this->sample_rate_ * this->interval_count_ / sum;
+}
+
+float PPGProcessor::get_spo2() const {
+  if (this->interval_count_ < 3 || std::isnan(this->ratio_) || this->ratio_ < 0.2f || this->ratio_ > 1.8f) {
+    return NAN;
+  }
+  // Maxim参考设计的R值-血氧标定曲线
+  float spo2 = -45.060f * this->ratio_ * this->ratio_ + 30.354f * this->ratio_ + 94.845f;
+  if (spo2 > 100.0f) {
+    spo2 = 100.0f;
+  }
+  return spo2 < 0.0f ? 0.0f : spo2;
+}
+
+float PPGProcessor::get_signal_quality() const {
+  if (std::isnan(this->ir_dc_) || this->ir_dc_ < this->finger_threshold_ || this->interval_count_ == 0) {
+    return 0.0f;
+  }
+  // 心跳间隔越规律质量越高，变异系数0.25以上视为不可用；心跳数不足时按比例降低
+  float mean = 0.0f;
+  for (uint8_t i = 0; i < this->interval_count_; i++) {
+    mean += this->intervals_[i];
+  }
+  mean /= this->interval_count_;
+  float var = 0.0f;
+  for (uint8_t i = 0; i < this->interval_count_; i++) {
+    float d = this->intervals_[i] - mean;
+    var += d * d;
+  }
+  float cv = std::sqrt(var / this->interval_count_) / mean;
+  float quality = 1.0f - cv / 0.25f;
+  if (quality < 0.0f) {
+    quality = 0.0f;
+  }
+  return 100.0f * quality * this->interval_count_ / PPG_MAX_INTERVALS;
+}
+
+}  // namespace max30105
+}  // namespace esphome
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace esphome {
+namespace max30105 {
+
+static const uint8_t PPG_MAX_INTERVALS = 8;  // 心率取最近8个心跳间隔的平均
+
+// 二阶IIR节（直接II型转置），系数由configure计算
+struct PPGBiquad {
+  float b0{1.0f}, b1{0.0f}, b2{0.0f}, a1{0.0f}, a2{0.0f};
+  float z1{0.0f}, z2{0.0f};
+
+  void set_bandpass(float sample_rate, float low_hz, float high_hz);
+  float apply(float x) {
+    float y = this->b0 * x + this->z1;
+    this->z1 = this->b1 * x - this->a1 * y + this->z2;
+    this->z2 = this->b2 * x - this->a2 * y;
+    return y;
+  }
+  void reset() { this->z1 = this->z2 = 0.0f; }
+};
+
+// 流式PPG处理：去直流 -> 带通 -> 峰值检测 -> 心率；红光/红外交流直流比 -> R值 -> 血氧
+// 所有状态都是定长成员，不做动态分配
+class PPGProcessor {
+ public:
+  // sample_rate为FIFO实际输出速率，full_scale为当前分辨率下的满量程计数
+  void configure(float sample_rate, uint32_t full_scale);
+  void reset();
+  // LED电流或ADC量程变化后重新跟踪直流，保留心跳历史
+  void rebase();
+  // ir用于心率检测；red为NAN时（仅红光模式）不计算血氧
+  void process(float ir, float red);
+
+  float get_heart_rate() const;
+  float get_spo2() const;
+  float get_signal_quality() const;
+
+ protected:
+  void on_peak_(uint32_t index);
+
+  float sample_rate_{50.0f};
+  float dc_alpha_{0.02f};         // 直流跟踪系数，时间常数约1秒
+  float threshold_decay_{0.99f};  // 峰值阈值衰减，丢拍后能重新锁定
+  float finger_threshold_{0.0f};  // 红外直流低于此值认为没有手指
+  uint32_t refractory_{0};        // 最短心跳间隔（样本数）
+  uint32_t max_interval_{0};      // 最长心跳间隔（样本数）
+
+  PPGBiquad ir_filter_;
+  PPGBiquad red_filter_;
+  float ir_dc_{NAN};
+  float red_dc_{NAN};
+
+  uint32_t index_{0};
+  float prev_{0.0f};
+  bool rising_{false};
+  float peak_level_{0.0f};
+  float threshold_{0.0f};
+  bool has_last_beat_{false};
+  uint32_t last_beat_{0};
+
+  std::array<uint32_t, PPG_MAX_INTERVALS> intervals_{};
+  uint8_t interval_head_{0};
+  uint8_t interval_count_{0};
+
+  // 每个心跳周期内的交流平方和，用于R值
+  float ir_ac_sq_{0.0f};
+  float red_ac_sq_{0.0f};
+  uint32_t ac_count_{0};
+  float ratio_{NAN};
+};
+
+}  // namespace max30105
+}  // namespace esphome
@@ -5,11 +5,19 @@ from esphome.const import (
     CONF_TEMPERATURE,
     CONF_DEBUG,
     UNIT_CELSIUS,
+    UNIT_PERCENT,
     DEVICE_CLASS_TEMPERATURE,
     STATE_CLASS_MEASUREMENT,
 )
 
-from . import CONF_MAX30105_ID, MAX30105Component
+from . import (
+    CONF_MAX30105_ID,
+    MAX30105Component,
+    max30105_ns,
+    CONF_DATA_READY,
+    CONF_ALC_OVERFLOW,
+    CONF_TEMPERATURE_READY,
+)
 
 DEPENDENCIES = ["max30105"]
 
@@ -20,6 +28,32 @@ CONF_LED4 = "led4"
 CONF_FIFO_OVERFLOW_COUNTER = "fifo_overflow_counter"
 CONF_WR_PTR = "wr_ptr"
 CONF_RD_PTR = "rd_ptr"
+CONF_HEART_RATE = "heart_rate"
+CONF_SPO2 = "spo2"
+CONF_SIGNAL_QUALITY = "signal_quality"
+UNIT_BEATS_PER_MINUTE = "bpm"
+CONF_EVENTS = "events"
+CONF_POWER_READY = "power_ready"
+CONF_PROXIMITY = "proximity"
+CONF_FIFO_FULL = "fifo_full"
+UNIT_EVENTS = "events"
+
+MAX30105_EVENT = max30105_ns.enum("MAX30105_EVENT")
+EVENT_TYPES = {
+    CONF_POWER_READY: MAX30105_EVENT.MAX30105_EVENT_POWER_READY,
+    CONF_PROXIMITY: MAX30105_EVENT.MAX30105_EVENT_PROXIMITY,
+    CONF_ALC_OVERFLOW: MAX30105_EVENT.MAX30105_EVENT_ALC_OVERFLOW,
+    CONF_DATA_READY: MAX30105_EVENT.MAX30105_EVENT_DATA_READY,
+    CONF_FIFO_FULL: MAX30105_EVENT.MAX30105_EVENT_FIFO_FULL,
+    CONF_TEMPERATURE_READY: MAX30105_EVENT.MAX30105_EVENT_TEMP_READY,
+}
+
+EVENT_COUNT_SCHEMA = sensor.sensor_schema(
+    unit_of_measurement=UNIT_EVENTS,
+    icon="mdi:counter",
+    accuracy_decimals=0,
+    state_class=STATE_CLASS_MEASUREMENT,
+)
 
 CONFIG_SCHEMA = cv.Schema(
     {
@@ -63,6 +97,28 @@ CONFIG_SCHEMA = cv.Schema(
             accuracy_decimals=1,
             state_class=STATE_CLASS_MEASUREMENT,
         ),
+        cv.Optional(CONF_HEART_RATE): sensor.sensor_schema(
+            unit_of_measurement=UNIT_BEATS_PER_MINUTE,
+            icon="mdi:heart-pulse",
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_MEASUREMENT,
+        ),
+        cv.Optional(CONF_SPO2): sensor.sensor_schema(
+            unit_of_measurement=UNIT_PERCENT,
+            icon="mdi:water-percent",
+            accuracy_decimals=1,
+            state_class=STATE_CLASS_MEASUREMENT,
+        ),
+        cv.Optional(CONF_SIGNAL_QUALITY): sensor.sensor_schema(
+            unit_of_measurement=UNIT_PERCENT,
+            icon="mdi:signal",
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_MEASUREMENT,
+        ),
+        # 每个update周期内各中断的次数
+        cv.Optional(CONF_EVENTS): cv.Schema(
+            {cv.Optional(key): EVENT_COUNT_SCHEMA for key in EVENT_TYPES}
+        ),
         cv.Optional(CONF_DEBUG): cv.Schema({
             cv.Optional(CONF_WR_PTR): sensor.sensor_schema(
                 icon="mdi:counter",
@@ -99,6 +155,20 @@ async def to_code(config):
     if fifo_overflow_counter := config.get(CONF_FIFO_OVERFLOW_COUNTER):
         sens = await sensor.new_sensor(fifo_overflow_counter)
         cg.add(max30105_component.set_fifo_overflow_counter_sensor(sens))
+    if heart_rate := config.get(CONF_HEART_RATE):
+        sens = await sensor.new_sensor(heart_rate)
+        cg.add(max30105_component.set_heart_rate_sensor(sens))
+    if spo2 := config.get(CONF_SPO2):
+        sens = await sensor.new_sensor(spo2)
+        cg.add(max30105_component.set_spo2_sensor(sens))
+    if signal_quality := config.get(CONF_SIGNAL_QUALITY):
+        sens = await sensor.new_sensor(signal_quality)
+        cg.add(max30105_component.set_signal_quality_sensor(sens))
+    if events_conf := config.get(CONF_EVENTS):
+        for key, event in EVENT_TYPES.items():
+            if event_conf := events_conf.get(key):
+                sens = await sensor.new_sensor(event_conf)
+                cg.add(max30105_component.set_event_count_sensor(event, sens))
     if debug_conf := config.get(CONF_DEBUG):
         if wr_ptr := debug_conf.get(CONF_WR_PTR):
             sens = await sensor.new_sensor(wr_ptr)
@@ -0,0 +1,10 @@
+# 问答式串口传感器共用的异步收发层，由各组件 AUTO_LOAD，不需要单独配置
+import esphome.codegen as cg
+import esphome.config_validation as cv
+
+CODEOWNERS = ["@synodriver"]
+DEPENDENCIES = ["uart"]
+
+uart_transaction_ns = cg.esphome_ns.namespace("uart_transaction")
+
+CONFIG_SCHEMA = cv.All(cv.Schema({}))
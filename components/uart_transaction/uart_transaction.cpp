@@ -0,0 +1,132 @@
+#include "uart_transaction.h"
+#include <algorithm>
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace uart_transaction {
+
+static const char *const TAG = "uart_transaction";
+
+uint8_t compute_checksum(ChecksumPolicy policy, const uint8_t *data, uint8_t len, uint8_t start) {
+  uint8_t sum = 0;
+  for (uint8_t i = start; i < len; i++) {
+    sum += data[i];
+  }
+  switch (policy) {
+    case CHECKSUM_SUM:
+      return sum;
+    case CHECKSUM_SUM_COMPLEMENT:
+      return (~sum) + 1;
+    default:
+      return 0;
+  }
+}
+
+bool UARTTransaction::send(const uint8_t *request, uint8_t len, const FrameDescriptor *response,
+                           ResponseCallback &&callback, uint32_t timeout) {
+  if (this->queue_count_ >= UART_TRANSACTION_QUEUE_SIZE || len > UART_TRANSACTION_MAX_REQUEST) {
+    ESP_LOGW(TAG, "Request dropped, queue full or request too long (%u bytes)", len);
+    return false;
+  }
+  Request &req = this->queue_[(this->queue_head_ + this->queue_count_) % UART_TRANSACTION_QUEUE_SIZE];
+  std::copy(request, request + len, req.data.begin());
+  req.len = len;
+  req.response = response;
+  req.callback = std::move(callback);
+  req.timeout = timeout;
+  this->queue_count_++;
+  if (!this->active_) {
+    this->start_next_();
+  }
+  return true;
+}
+
+void UARTTransaction::loop() {
+  if (this->active_) {
+    this->receive_();
+    if (this->active_ && millis() - this->start_time_ > this->queue_[this->queue_head_].timeout) {
+      ESP_LOGV(TAG, "Response timeout, got %u bytes", this->received_);
+      this->finish_(TRANSACTION_TIMEOUT);
+    }
+  }
+  if (!this->active_) {
+    this->start_next_();
+  }
+}
+
+void UARTTransaction::start_next_() {
+  while (!this->active_ && this->queue_count_ > 0) {
+    Request &req = this->queue_[this->queue_head_];
+    // 丢弃残留数据，保证读到的是本次应答
+    while (this->device_->available()) {
+      this->device_->read();
+    }
+    this->device_->write_array(req.data.data(), req.len);
+    this->received_ = 0;
+    if (req.response == nullptr) {
+      this->finish_(TRANSACTION_OK);  // 只发不收
+      continue;
+    }
+    this->expected_ = std::min(req.response->length, UART_TRANSACTION_MAX_FRAME);
+    this->active_ = true;
+    this->start_time_ = millis();
+  }
+}
+
+void UARTTransaction::receive_() {
+  const FrameDescriptor &frame = *this->queue_[this->queue_head_].response;
+  while (this->active_ && this->device_->available()) {
+    uint8_t c;
+    if (!this->device_->read_byte(&c)) {
+      return;
+    }
+    if (this->received_ < frame.header_len && c != frame.header[this->received_]) {
+      // 帧头不匹配，从这个字节重新找帧头
+      this->received_ = 0;
+      if (frame.header_len == 0 || c != frame.header[0]) {
+        continue;
+      }
+    }
+    this->buffer_[this->received_++] = c;
+    if (frame.length_index > 0 && this->received_ == frame.length_index + 1) {
+      uint16_t total = c + frame.length_offset;
+      if (total <= frame.length_index + 1 || total > this->expected_) {
+        ESP_LOGV(TAG, "Frame length %u out of range", total);
+        this->finish_(TRANSACTION_MALFORMED);
+        return;
+      }
+      this->expected_ = total;
+    }
+    if (this->received_ < this->expected_) {
+      continue;
+    }
+    if (frame.checksum != CHECKSUM_NONE) {
+      uint8_t last = this->expected_ - 1;
+      uint8_t expected = compute_checksum(frame.checksum, this->buffer_.data(), last, frame.checksum_start);
+      if (expected != this->buffer_[last]) {
+        ESP_LOGV(TAG, "Checksum mismatch: 0x%02X != 0x%02X", this->buffer_[last], expected);
+        this->finish_(TRANSACTION_CHECKSUM_ERROR);
+        return;
+      }
+    }
+    // 回调里可能已经发出下一个请求，它的应答留到下一次loop()按新的帧描述解析
+    this->finish_(TRANSACTION_OK);
+    return;
+  }
+}
+
+void UARTTransaction::finish_(TransactionStatus status) {
+  // 先出队再回调，回调里可以直接发起下一个请求
+  ResponseCallback callback = std::move(this->queue_[this->queue_head_].callback);
+  this->queue_[this->queue_head_].callback = nullptr;
+  this->queue_head_ = (this->queue_head_ + 1) % UART_TRANSACTION_QUEUE_SIZE;
+  this->queue_count_--;
+  this->active_ = false;
+  if (callback) {
+    callback(status, this->buffer_.data(), this->received_);
+  }
+}
+
+}  // namespace uart_transaction
+}  // namespace esphome
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <functional>
+#include "esphome/components/uart/uart.h"
+
+namespace esphome {
+namespace uart_transaction {
+
+// 串口问答的非阻塞收发层：请求在update()里排队发出，应答在所属组件的loop()里按到达的字节拼装，
+// 完成、校验失败或超时时回调，不再用read_array阻塞主循环
+
+enum ChecksumPolicy : uint8_t {
+  CHECKSUM_NONE = 0,
+  CHECKSUM_SUM,             // 最后一个字节 = 前面字节之和
+  CHECKSUM_SUM_COMPLEMENT,  // 最后一个字节 = 前面字节之和取反加一，即全部相加为0
+};
+
+enum TransactionStatus : uint8_t {
+  TRANSACTION_OK = 0,
+  TRANSACTION_TIMEOUT,
+  TRANSACTION_CHECKSUM_ERROR,
+  TRANSACTION_MALFORMED,  // 长度字节超出范围
+};
+
+// 应答帧描述：帧头、总长度（含帧头和校验字节）、校验方式及参与校验的起始下标。
+// length_index非0时为变长帧：总长度 = data[length_index] + length_offset，length为允许的最大长度
+struct FrameDescriptor {
+  std::array<uint8_t, 2> header;
+  uint8_t header_len;
+  uint8_t length;
+  ChecksumPolicy checksum;
+  uint8_t checksum_start;
+  uint8_t length_index{0};
+  uint8_t length_offset{0};
+};
+
+static const uint8_t UART_TRANSACTION_MAX_FRAME = 32;
+static const uint8_t UART_TRANSACTION_MAX_REQUEST = 16;
+static const uint8_t UART_TRANSACTION_QUEUE_SIZE = 4;
+static const uint32_t UART_TRANSACTION_DEFAULT_TIMEOUT = 100;
+
+using ResponseCallback = std::function<void(TransactionStatus status, const uint8_t *data, uint8_t len)>;
+
+// 按policy计算data[start, len)的校验字节
+uint8_t compute_checksum(ChecksumPolicy policy, const uint8_t *data, uint8_t len, uint8_t start = 0);
+
+class UARTTransaction {
+ public:
+  explicit UARTTransaction(uart::UARTDevice *device) : device_(device) {}
+
+  // 请求排队发送；response为nullptr时只发不收。队列满时返回false
+  bool send(const uint8_t *request, uint8_t len, const FrameDescriptor *response, ResponseCallback &&callback,
+            uint32_t timeout = UART_TRANSACTION_DEFAULT_TIMEOUT);
+  // 由所属组件的loop()调用：接收应答、处理超时、发出下一个请求
+  void loop();
+  bool is_busy() const { return this->active_ || this->queue_count_ > 0; }
+
+ protected:
+  struct Request {
+    std::array<uint8_t, UART_TRANSACTION_MAX_REQUEST> data;
+    uint8_t len;
+    const FrameDescriptor *response;
+    ResponseCallback callback;
+    uint32_t timeout;
+  };
+
+  void start_next_();
+  void receive_();
+  void finish_(TransactionStatus status);
+
+  uart::UARTDevice *device_;
+  std::array<Request, UART_TRANSACTION_QUEUE_SIZE> queue_{};
+  uint8_t queue_head_{0};
+  uint8_t queue_count_{0};
+
+  bool active_{false};  // 正在等待queue_[queue_head_]的应答
+  uint32_t start_time_{0};
+  std::array<uint8_t, UART_TRANSACTION_MAX_FRAME> buffer_{};
+  uint8_t received_{0};
+  uint8_t expected_{0};  // 本帧总长度，变长帧收到长度字节后确定
+};
+
+}  // namespace uart_transaction
+}  // namespace esphome
@@ -6,15 +6,25 @@ from esphome.const import (
     CONF_FORMALDEHYDE,
     CONF_UPDATE_INTERVAL,
     CONF_MODE,
+    CONF_TYPE,
     UNIT_MICROGRAMS_PER_CUBIC_METER,
     UNIT_PARTS_PER_BILLION,
     ICON_CHEMICAL_WEAPON,
 	STATE_CLASS_MEASUREMENT,
+    STATE_CLASS_TOTAL_INCREASING,
 )
 CONF_FORMALDEHYDE_PPB = "formaldehyde_ppb"
+CONF_FRAMES_OK = "frames_ok"
+CONF_CHECKSUM_ERRORS = "checksum_errors"
+CONF_RESYNCS = "resyncs"
+CONF_AGGREGATE = "aggregate"
+CONF_FRAMES = "frames"
+CONF_WINDOW = "window"
+CONF_DEADBAND = "deadband"
 
 
 DEPENDENCIES = ["uart"]
+AUTO_LOAD = ["uart_transaction"]
 
 dart_ns = cg.esphome_ns.namespace("ws_z")
 DARTWSZComponent = dart_ns.class_("DARTWSZComponent", cg.PollingComponent, uart.UARTDevice)
@@ -23,6 +33,25 @@ DARTWS_MODE_OPTIONS = {
     "passive": DARTWS_MODE.DARTWS_MODE_PASSIVE,
     "active": DARTWS_MODE.DARTWS_MODE_ACTIVE,
 }
+DARTWS_AGGREGATE = dart_ns.enum("DARTWS_AGGREGATE")
+DARTWS_AGGREGATE_OPTIONS = {
+    "last": DARTWS_AGGREGATE.DARTWS_AGGREGATE_LAST,
+    "mean": DARTWS_AGGREGATE.DARTWS_AGGREGATE_MEAN,
+    "max": DARTWS_AGGREGATE.DARTWS_AGGREGATE_MAX,
+}
+
+# 主动上传模式每秒一帧，按帧数或时间窗口聚合后再发布
+AGGREGATE_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.Optional(CONF_TYPE, default="last"): cv.enum(DARTWS_AGGREGATE_OPTIONS),
+            cv.Optional(CONF_FRAMES): cv.int_range(min=1, max=3600),
+            cv.Optional(CONF_WINDOW): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_DEADBAND, default=0): cv.positive_float,
+        }
+    ),
+    cv.has_at_most_one_key(CONF_FRAMES, CONF_WINDOW),
+)
 
 CONFIG_SCHEMA = cv.All(
     cv.Schema(
@@ -41,6 +70,23 @@ CONFIG_SCHEMA = cv.All(
                 state_class=STATE_CLASS_MEASUREMENT,
             ),
             cv.Optional(CONF_MODE, default="passive"): cv.enum(DARTWS_MODE_OPTIONS),
+            cv.Optional(CONF_AGGREGATE): AGGREGATE_SCHEMA,
+            # 主动上传模式的解析统计
+            cv.Optional(CONF_FRAMES_OK): sensor.sensor_schema(
+                icon="mdi:counter",
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_TOTAL_INCREASING,
+            ),
+            cv.Optional(CONF_CHECKSUM_ERRORS): sensor.sensor_schema(
+                icon="mdi:counter",
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_TOTAL_INCREASING,
+            ),
+            cv.Optional(CONF_RESYNCS): sensor.sensor_schema(
+                icon="mdi:counter",
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_TOTAL_INCREASING,
+            ),
 		}
     )
     .extend(cv.polling_component_schema("20s"))
@@ -60,5 +106,20 @@ async def to_code(config):
         sens = await sensor.new_sensor(config[CONF_FORMALDEHYDE_PPB])
         cg.add(var.set_formaldehyde_ppb_sensor(sens))
     cg.add(var.set_mode(config[CONF_MODE]))
+    if aggregate := config.get(CONF_AGGREGATE):
+        cg.add(var.set_aggregate(aggregate[CONF_TYPE]))
+        cg.add(var.set_aggregate_frames(aggregate.get(CONF_FRAMES, 1)))
+        if CONF_WINDOW in aggregate:
+            cg.add(var.set_aggregate_window(aggregate[CONF_WINDOW]))
+        cg.add(var.set_deadband(aggregate[CONF_DEADBAND]))
+    if CONF_FRAMES_OK in config:
+        sens = await sensor.new_sensor(config[CONF_FRAMES_OK])
+        cg.add(var.set_frames_ok_sensor(sens))
+    if CONF_CHECKSUM_ERRORS in config:
+        sens = await sensor.new_sensor(config[CONF_CHECKSUM_ERRORS])
+        cg.add(var.set_checksum_errors_sensor(sens))
+    if CONF_RESYNCS in config:
+        sens = await sensor.new_sensor(config[CONF_RESYNCS])
+        cg.add(var.set_resyncs_sensor(sens))
     # if CONF_UPDATE_INTERVAL in config:
     #     cg.add(var.set_update_interval(config[CONF_UPDATE_INTERVAL]))
\ No newline at end of file
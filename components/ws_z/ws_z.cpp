@@ -1,4 +1,5 @@
 #include "ws_z.h"
+#include <algorithm>
 #include "esphome/core/log.h"
 
 namespace esphome {
@@ -15,165 +16,232 @@ static const uint8_t DART_COMMAND_GET_PPM[] = {0xFF, 0x01, 0x86, 0x00, 0x00, 0x0
 static const uint8_t DART_COMMAND_SET_QA[] = {0xFF, 0x01, 0x78, 0x41, 0x00, 0x00, 0x00, 0x00};  // 切换到问答模式
 static const uint8_t DART_COMMAND_SET_NQA[] = {0xFF, 0x01, 0x78, 0x40, 0x00, 0x00, 0x00, 0x00};  // 切换到主动上传模式
 
-uint8_t dart_checksum(const uint8_t *command) {
-  uint8_t sum = 0;
-  // datasheet 算法：sum bytes[1..7], 然后取反 + 1
-  for (uint8_t i = 1; i < DART_REQUEST_LENGTH; i++) {
-    sum += command[i];
-  }
-  sum = (~sum) + 1;
-  return sum;
-}
+// 切换模式的应答只确认收到；读数应答的校验同请求：bytes[1..7]之和取反加一
+static const uart_transaction::FrameDescriptor DART_RESPONSE_SET_QA = {
+    {0xFF, 0x00}, 1, DART_RESPONSE_LENGTH, uart_transaction::CHECKSUM_NONE, 0};
+static const uart_transaction::FrameDescriptor DART_RESPONSE_GET_PPM = {
+    {0xFF, 0x86}, 2, DART_RESPONSE_LENGTH, uart_transaction::CHECKSUM_SUM_COMPLEMENT, 1};
 
 void DARTWSZComponent::setup() {
-  uint8_t response[DART_RESPONSE_LENGTH];
-
   if (this->mode_ == DARTWS_MODE_PASSIVE) {
-    // 切到问答（被动）模式，等待一次响应确认
-    if (!this->dart_write_command_(DART_COMMAND_SET_QA, response)) {
-      ESP_LOGW(TAG, "Setting DART WS-Z to QA (passive) mode failed!");
-      this->status_set_warning();
-      return;
-    } else {
+    // 切到问答（被动）模式，应答在loop()中确认
+    this->dart_write_command_(DART_COMMAND_SET_QA, &DART_RESPONSE_SET_QA,
+                              [this](uart_transaction::TransactionStatus status, const uint8_t *data, uint8_t len) {
+      if (status != uart_transaction::TRANSACTION_OK) {
+        ESP_LOGW(TAG, "Setting DART WS-Z to QA (passive) mode failed!");
+        this->status_set_warning();
+        return;
+      }
       ESP_LOGD(TAG, "DART WS-Z set to QA (passive) mode.");
       this->status_clear_warning();
-    }
+    });
   } else {  // ACTIVE
-    // 切到主动上传模式（不需要等待返包，但是要发送命令并清空串口缓存）
-    if (!this->dart_write_command_(DART_COMMAND_SET_NQA, nullptr)) {
+    // 切到主动上传模式，不需要等待返包；切换期间的残留字节由逐字节解析器重新同步丢弃
+    if (!this->dart_write_command_(DART_COMMAND_SET_NQA, nullptr, nullptr)) {
       ESP_LOGW(TAG, "Setting DART WS-Z to NQA (active) mode failed!");
       this->status_set_warning();
       // don't return here — 仍然可以尝试处理来着主动上报的包
     } else {
       ESP_LOGD(TAG, "DART WS-Z set to NQA (active) mode.");
-      this->status_clear_warning();
-    }
-    // 给模块一些时间切换并开始上报（短延时）
-    delay(200);
-    // 丢弃 RX buffer 的残留数据，保证后续读取的是新帧
-    while (this->available()) {
-      this->read();
     }
   }
 }
 
 void DARTWSZComponent::update() {
+  if (this->frames_ok_sensor_ != nullptr) {
+    this->frames_ok_sensor_->publish_state(this->frames_ok_);
+  }
+  if (this->checksum_errors_sensor_ != nullptr) {
+    this->checksum_errors_sensor_->publish_state(this->checksum_errors_);
+  }
+  if (this->resyncs_sensor_ != nullptr) {
+    this->resyncs_sensor_->publish_state(this->resyncs_);
+  }
   if (this->mode_ == DARTWS_MODE_PASSIVE) {
-    uint8_t response[DART_RESPONSE_LENGTH];
-    if (!this->dart_write_command_(DART_COMMAND_GET_PPM, response)) {
-      ESP_LOGW(TAG, "Reading data from DART WS-Z failed!");
-      this->status_set_warning();
-      return;
-    }
-
-    if (response[0] != 0xFF || response[1] != 0x86) {
-      ESP_LOGW(TAG, "Invalid preamble from DART WS-Z!");
-      this->status_set_warning();
-      return;
-    }
-
-    uint8_t checksum = dart_checksum(response);
-    if (response[8] != checksum) {
-      ESP_LOGW(TAG, "DART WS-Z Checksum doesn't match: 0x%02X!=0x%02X", response[8], checksum);
-      this->status_set_warning();
-      return;
-    }
+    this->dart_write_command_(DART_COMMAND_GET_PPM, &DART_RESPONSE_GET_PPM,
+                              [this](uart_transaction::TransactionStatus status, const uint8_t *response, uint8_t len) {
+      if (status == uart_transaction::TRANSACTION_CHECKSUM_ERROR) {
+        ESP_LOGW(TAG, "DART WS-Z Checksum doesn't match!");
+        this->status_set_warning();
+        return;
+      }
+      if (status != uart_transaction::TRANSACTION_OK) {
+        ESP_LOGW(TAG, "Reading data from DART WS-Z failed!");
+        this->status_set_warning();
+        return;
+      }
 
-    this->status_clear_warning();
-    const uint16_t ch2oh_mg = uint16_t(response[2]) * 256 + response[3];
-    const uint16_t ch20h_ppb = uint16_t(response[6]) * 256 + response[7];
+      this->status_clear_warning();
+      const uint16_t ch2oh_mg = uint16_t(response[2]) * 256 + response[3];
+      const uint16_t ch20h_ppb = uint16_t(response[6]) * 256 + response[7];
 
-    ESP_LOGD(TAG, "DART WS-Z Received HCHO=%u µg/m³, %u ppb, %02X %02X %02X %02X %02X %02X %02X %02X %02X",
-             ch2oh_mg, ch20h_ppb,
-             response[0], response[1], response[2], response[3], response[4], response[5], response[6], response[7],
-             response[8]);
-    if (this->formaldehyde_sensor_ != nullptr) {
-      this->formaldehyde_sensor_->publish_state(ch2oh_mg);
-    }
-    if (this->formaldehyde_ppb_sensor_ != nullptr) {
-      this->formaldehyde_ppb_sensor_->publish_state(ch20h_ppb);
-    }
+      ESP_LOGD(TAG, "DART WS-Z Received HCHO=%u µg/m³, %u ppb, %02X %02X %02X %02X %02X %02X %02X %02X %02X",
+               ch2oh_mg, ch20h_ppb,
+               response[0], response[1], response[2], response[3], response[4], response[5], response[6], response[7],
+               response[8]);
+      if (this->formaldehyde_sensor_ != nullptr) {
+        this->formaldehyde_sensor_->publish_state(ch2oh_mg);
+      }
+      if (this->formaldehyde_ppb_sensor_ != nullptr) {
+        this->formaldehyde_ppb_sensor_->publish_state(ch20h_ppb);
+      }
+    });
   }
 }
 
 void DARTWSZComponent::loop() {
+  this->transaction_.loop();
   if (this->mode_ == DARTWS_MODE_ACTIVE) {
-    while (this->available()) {
+    // 只消费已经到达的字节，半帧留在窗口里等下一次loop，不阻塞
+    size_t len = this->available();
+    while (len-- > 0) {
       uint8_t c;
       if (!this->read_byte(&c)) {
         return;
       }
-      // 寻找 0xFF 帧头
-      if (c != 0xFF) {
-        continue;
-      }
+      this->feed_byte_(c);
+    }
+    // 按时间窗口聚合时，帧停了也要按时输出
+    if (this->aggregate_window_ > 0 && this->aggregate_count_ > 0 &&
+        millis() - this->aggregate_start_ >= this->aggregate_window_) {
+      this->flush_aggregate_();
+    }
+  }
+}
 
-      // 找到帧头后，读取后续的8个字节数据
-      uint8_t data[8];
-      if (!this->read_array(data, 8)) {
-        return;
+void DARTWSZComponent::feed_byte_(uint8_t c) {
+  if (this->frame_len_ == 0) {
+    // 寻找 0xFF 帧头
+    if (c != 0xFF) {
+      if (!this->hunting_) {
+        this->hunting_ = true;
+        this->resyncs_++;
       }
+      return;
+    }
+    this->hunting_ = false;
+  }
+  this->frame_[this->frame_len_++] = c;
+  if (this->frame_len_ < this->frame_.size()) {
+    return;
+  }
 
-      // 校验和检查：对 data[0..7] 求和（包含 checksum），如果和 != 0 说明校验失败
-      uint8_t sum = 0;
-      for (int i = 0; i < 8; i++) {
-        sum += data[i];
-      }
+  // 校验和检查：对帧头之后的8个字节求和（包含 checksum），如果和 != 0 说明校验失败
+  uint8_t sum = 0;
+  for (uint8_t i = 1; i < this->frame_.size(); i++) {
+    sum += this->frame_[i];
+  }
+  if (sum == 0) {
+    this->frames_ok_++;
+    this->frame_len_ = 0;
+    this->handle_active_frame_(&this->frame_[1]);
+    return;
+  }
 
-      if (sum != 0) {
-        // 校验失败的数据包直接丢弃
-        ESP_LOGW(TAG, "Checksum failed! Discarding packet. Sum: 0x%02X", sum);
-        continue;
-      }
+  this->checksum_errors_++;
+  ESP_LOGW(TAG, "Checksum failed! Resyncing. Sum: 0x%02X", sum);
+  // 真正的帧头可能就在这9个字节里，窗口滑到下一个0xFF继续
+  this->resyncs_++;
+  uint8_t start = 1;
+  while (start < this->frame_.size() && this->frame_[start] != 0xFF) {
+    start++;
+  }
+  this->frame_len_ = this->frame_.size() - start;
+  for (uint8_t i = 0; i < this->frame_len_; i++) {
+    this->frame_[i] = this->frame_[start + i];
+  }
+}
 
-      // 兼容两种常见的主动上报帧格式：
-      // 1) 被动/问答风格（第二字节 0x86）：格式与被动响应相同，只不过是主动发送
-      //    在这里 data[0] == 0x86，此时对应被动响应中的 response[1]，index 映射如下：
-      //    response[2] -> data[1], response[3] -> data[2]
-      //    response[6] -> data[5], response[7] -> data[6]
-      // 2) ID=0x17 + unit=0x04 风格：按照原来实现解析 data[3], data[4]
-      if (data[0] == 0x86) {
-        // 解析与被动响应相同
-        uint16_t ugm3 = (uint16_t(data[1]) << 8) | uint16_t(data[2]);   // response[2,3]
-        uint16_t ppb = (uint16_t(data[5]) << 8) | uint16_t(data[6]);    // response[6,7]
-
-        ESP_LOGD(TAG, "Active frame (86-style) Received HCHO=%u µg/m³, %u ppb", ugm3, ppb);
-        if (this->formaldehyde_sensor_ != nullptr) {
-          this->formaldehyde_sensor_->publish_state(ugm3);
-        }
-        if (this->formaldehyde_ppb_sensor_ != nullptr) {
-          this->formaldehyde_ppb_sensor_->publish_state(ppb);
-        }
-      } else if (data[0] == 0x17 && data[1] == 0x04) {
-        // 原有的 ID/Unit 风格（保留）
-        uint32_t val = (uint32_t(data[3]) << 8) | uint32_t(data[4]);
-        ESP_LOGD(TAG, "Active frame (17-style) Received HCHO ppb=%u", val);
-        if (this->formaldehyde_ppb_sensor_ != nullptr) {
-          this->formaldehyde_ppb_sensor_->publish_state(val);
-        }
-      } else {
-        // 未知格式：打印全部字节，便于调试真实设备上报的内容
-        ESP_LOGW(TAG, "Ignoring frame with unknown ID/Unit. ID: 0x%02X, Unit: 0x%02X (raw: %02X %02X %02X %02X %02X %02X %02X %02X)",
-                 data[0], data[1],
-                 data[0], data[1], data[2], data[3], data[4], data[5], data[6], data[7]);
-      }
-    }
+void DARTWSZComponent::handle_active_frame_(const uint8_t *data) {
+  // 兼容两种常见的主动上报帧格式：
+  // 1) 被动/问答风格（第二字节 0x86）：格式与被动响应相同，只不过是主动发送
+  //    在这里 data[0] == 0x86，此时对应被动响应中的 response[1]，index 映射如下：
+  //    response[2] -> data[1], response[3] -> data[2]
+  //    response[6] -> data[5], response[7] -> data[6]
+  // 2) ID=0x17 + unit=0x04 风格：按照原来实现解析 data[3], data[4]
+  if (data[0] == 0x86) {
+    // 解析与被动响应相同
+    uint16_t ugm3 = (uint16_t(data[1]) << 8) | uint16_t(data[2]);   // response[2,3]
+    uint16_t ppb = (uint16_t(data[5]) << 8) | uint16_t(data[6]);    // response[6,7]
+
+    ESP_LOGV(TAG, "Active frame (86-style) Received HCHO=%u µg/m³, %u ppb", ugm3, ppb);
+    this->add_sample_(this->ugm3_aggregate_, ugm3);
+    this->add_sample_(this->ppb_aggregate_, ppb);
+  } else if (data[0] == 0x17 && data[1] == 0x04) {
+    // 原有的 ID/Unit 风格（保留）
+    uint32_t val = (uint32_t(data[3]) << 8) | uint32_t(data[4]);
+    ESP_LOGV(TAG, "Active frame (17-style) Received HCHO ppb=%u", val);
+    this->add_sample_(this->ppb_aggregate_, val);
+  } else {
+    // 未知格式：打印全部字节，便于调试真实设备上报的内容
+    ESP_LOGW(TAG, "Ignoring frame with unknown ID/Unit. ID: 0x%02X, Unit: 0x%02X (raw: %02X %02X %02X %02X %02X %02X %02X %02X)",
+             data[0], data[1],
+             data[0], data[1], data[2], data[3], data[4], data[5], data[6], data[7]);
+    return;
+  }
+  if (this->aggregate_count_ == 0) {
+    this->aggregate_start_ = millis();
+  }
+  this->aggregate_count_++;
+  if (this->aggregate_window_ == 0 && this->aggregate_count_ >= this->aggregate_frames_) {
+    this->flush_aggregate_();
   }
 }
 
+void DARTWSZComponent::add_sample_(DARTWSAggregate &channel, float value) {
+  channel.sum += value;
+  channel.max = (std::isnan(channel.max) || value > channel.max) ? value : channel.max;
+  channel.last = value;
+  channel.count++;
+}
+
+void DARTWSZComponent::flush_aggregate_() {
+  this->flush_channel_(this->ugm3_aggregate_);
+  this->flush_channel_(this->ppb_aggregate_);
+  this->aggregate_count_ = 0;
+}
 
-bool DARTWSZComponent::dart_write_command_(const uint8_t *command, uint8_t *response) {
-  // Empty RX Buffer
-  while (this->available()) {
-    this->read();
+void DARTWSZComponent::flush_channel_(DARTWSAggregate &channel) {
+  if (channel.count == 0) {
+    return;
+  }
+  float value;
+  switch (this->aggregate_) {
+    case DARTWS_AGGREGATE_MEAN:
+      value = channel.sum / channel.count;
+      break;
+    case DARTWS_AGGREGATE_MAX:
+      value = channel.max;
+      break;
+    default:
+      value = channel.last;
+      break;
   }
-  this->write_array(command, DART_REQUEST_LENGTH);
-  this->write_byte(dart_checksum(command));
-  this->flush();
-  if (response == nullptr)
-    return true;
+  uint16_t frames = channel.count;
+  channel.sum = 0.0f;
+  channel.max = NAN;
+  channel.count = 0;
+  // 与上次发布值相比变化不超过死区则不发布；死区为0（默认，未配置aggregate时也是0）表示每次都发布
+  if (this->deadband_ > 0.0f && !std::isnan(channel.published) &&
+      std::fabs(value - channel.published) <= this->deadband_) {
+    return;
+  }
+  channel.published = value;
+  if (channel.sensor != nullptr) {
+    ESP_LOGD(TAG, "Publishing '%s' %.1f over %u frames", channel.sensor->get_name().c_str(), value, frames);
+    channel.sensor->publish_state(value);
+  }
+}
 
-  return this->read_array(response, DART_RESPONSE_LENGTH);
+
+bool DARTWSZComponent::dart_write_command_(const uint8_t *command, const uart_transaction::FrameDescriptor *response,
+                                           uart_transaction::ResponseCallback &&callback) {
+  // datasheet 算法：sum bytes[1..7], 然后取反 + 1
+  uint8_t request[DART_REQUEST_LENGTH + 1];
+  std::copy(command, command + DART_REQUEST_LENGTH, request);
+  request[DART_REQUEST_LENGTH] =
+      uart_transaction::compute_checksum(uart_transaction::CHECKSUM_SUM_COMPLEMENT, command, DART_REQUEST_LENGTH, 1);
+  return this->transaction_.send(request, DART_REQUEST_LENGTH + 1, response, std::move(callback));
 }
 
 float DARTWSZComponent::get_setup_priority() const { return setup_priority::DATA; }
@@ -182,6 +250,18 @@ void DARTWSZComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "DART WS-Z:");
   LOG_SENSOR("  ", "HCHO ", this->formaldehyde_sensor_);
   LOG_SENSOR("  ", "HCHO PPB", this->formaldehyde_ppb_sensor_);
+  LOG_SENSOR("  ", "Frames OK", this->frames_ok_sensor_);
+  LOG_SENSOR("  ", "Checksum Errors", this->checksum_errors_sensor_);
+  LOG_SENSOR("  ", "Resyncs", this->resyncs_sensor_);
+  if (this->mode_ == DARTWS_MODE_ACTIVE) {
+    if (this->aggregate_window_ > 0) {
+      ESP_LOGCONFIG(TAG, "  Aggregate: %u over %u ms, deadband %.1f", this->aggregate_, (unsigned) this->aggregate_window_,
+                    this->deadband_);
+    } else {
+      ESP_LOGCONFIG(TAG, "  Aggregate: %u over %u frames, deadband %.1f", this->aggregate_, this->aggregate_frames_,
+                    this->deadband_);
+    }
+  }
   this->check_uart_settings(9600);
 }
 
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <array>
+#include <cmath>
 #include <vector>
 #include "esphome/core/component.h"
 #include "esphome/core/automation.h"
 #include "esphome/components/sensor/sensor.h"
 #include "esphome/components/uart/uart.h"
+#include "esphome/components/uart_transaction/uart_transaction.h"
 
 namespace esphome {
 namespace ws_z {
@@ -17,6 +20,23 @@ enum DARTWS_MODE : uint8_t {
   DARTWS_MODE_ACTIVE, // 主动上传模式
 };
 
+// 主动上传模式下多帧聚合的方式
+enum DARTWS_AGGREGATE : uint8_t {
+  DARTWS_AGGREGATE_LAST = 0,
+  DARTWS_AGGREGATE_MEAN,
+  DARTWS_AGGREGATE_MAX,
+};
+
+// 单个通道的聚合状态
+struct DARTWSAggregate {
+  sensor::Sensor *sensor{nullptr};
+  float sum{0.0f};
+  float max{NAN};
+  float last{NAN};
+  uint16_t count{0};
+  float published{NAN};  // 上次发布的值，用于死区判断
+};
+
 class DARTWSZComponent : public PollingComponent, public uart::UARTDevice {
  public:
   DARTWSZComponent() = default;
@@ -25,16 +45,63 @@ class DARTWSZComponent : public PollingComponent, public uart::UARTDevice {
   void update() override;
   void dump_config() override;
   void loop() override;
-  void set_formaldehyde_sensor(sensor::Sensor *formaldehyde_sensor)  { formaldehyde_sensor_ = formaldehyde_sensor; }
-  void set_formaldehyde_ppb_sensor(sensor::Sensor *formaldehyde_ppb_sensor) { formaldehyde_ppb_sensor_ = formaldehyde_ppb_sensor; }
+  void set_formaldehyde_sensor(sensor::Sensor *formaldehyde_sensor) {
+    formaldehyde_sensor_ = formaldehyde_sensor;
+    this->ugm3_aggregate_.sensor = formaldehyde_sensor;
+  }
+  void set_formaldehyde_ppb_sensor(sensor::Sensor *formaldehyde_ppb_sensor) {
+    formaldehyde_ppb_sensor_ = formaldehyde_ppb_sensor;
+    this->ppb_aggregate_.sensor = formaldehyde_ppb_sensor;
+  }
+  void set_aggregate(DARTWS_AGGREGATE aggregate) { this->aggregate_ = aggregate; }
+  void set_aggregate_frames(uint16_t frames) { this->aggregate_frames_ = frames; }
+  void set_aggregate_window(uint32_t window) { this->aggregate_window_ = window; }
+  void set_deadband(float deadband) { this->deadband_ = deadband; }
   void set_mode(DARTWS_MODE mode) { this->mode_ = mode;}
+  void set_frames_ok_sensor(sensor::Sensor *frames_ok_sensor) { this->frames_ok_sensor_ = frames_ok_sensor; }
+  void set_checksum_errors_sensor(sensor::Sensor *checksum_errors_sensor) {
+    this->checksum_errors_sensor_ = checksum_errors_sensor;
+  }
+  void set_resyncs_sensor(sensor::Sensor *resyncs_sensor) { this->resyncs_sensor_ = resyncs_sensor; }
+  uint32_t get_frames_ok() const { return this->frames_ok_; }
+  uint32_t get_checksum_errors() const { return this->checksum_errors_; }
+  uint32_t get_resyncs() const { return this->resyncs_; }
  
  protected:
-  bool dart_write_command_(const uint8_t *command, uint8_t *response);
+  // 补上校验字节后排队发送；response为nullptr时只发不收
+  bool dart_write_command_(const uint8_t *command, const uart_transaction::FrameDescriptor *response,
+                           uart_transaction::ResponseCallback &&callback);
+  uart_transaction::UARTTransaction transaction_{this};
   sensor::Sensor *formaldehyde_sensor_{nullptr};
   sensor::Sensor *formaldehyde_ppb_sensor_{nullptr};
   DARTWS_MODE mode_;
   std::vector<uint8_t> buffer;
+
+  // 主动上传模式的逐字节解析：9字节滑动窗口，校验失败时从窗口内下一个0xFF重新同步
+  void feed_byte_(uint8_t c);
+  void handle_active_frame_(const uint8_t *data);
+  std::array<uint8_t, 9> frame_{};
+  uint8_t frame_len_{0};
+  bool hunting_{false};  // 正在丢弃帧头之前的杂字节
+  uint32_t frames_ok_{0};
+  uint32_t checksum_errors_{0};
+  uint32_t resyncs_{0};
+  sensor::Sensor *frames_ok_sensor_{nullptr};
+  sensor::Sensor *checksum_errors_sensor_{nullptr};
+  sensor::Sensor *resyncs_sensor_{nullptr};
+
+  // 主动上传模式的抽取/聚合：每aggregate_frames_帧或每aggregate_window_毫秒输出一次，变化不超过死区不发布
+  void add_sample_(DARTWSAggregate &channel, float value);
+  void flush_aggregate_();
+  void flush_channel_(DARTWSAggregate &channel);
+  DARTWS_AGGREGATE aggregate_{DARTWS_AGGREGATE_LAST};
+  uint16_t aggregate_frames_{1};
+  uint32_t aggregate_window_{0};  // 0表示按帧数
+  uint32_t aggregate_start_{0};
+  uint16_t aggregate_count_{0};
+  float deadband_{0.0f};
+  DARTWSAggregate ugm3_aggregate_;
+  DARTWSAggregate ppb_aggregate_;
 };
 
 
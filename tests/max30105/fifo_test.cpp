@@ -0,0 +1,409 @@
+// MAX30105 FIFO的主机测试：指针回绕、空/满区分、各分辨率解码、各采样率/平均次数的周期，
+// 以及用I2C寄存器模型模拟芯片写FIFO，驱动真实的read_fifo()读空，核对样本一个不丢
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include "max30105/max30105.h"
+
+using namespace esphome;
+using namespace esphome::max30105;
+
+static uint32_t now_us = 0;
+
+namespace esphome {
+uint32_t micros() { return now_us; }
+uint32_t millis() { return now_us / 1000; }
+}  // namespace esphome
+
+static int failures = 0;
+
+#define CHECK(cond) \
+  do { \
+    if (!(cond)) { \
+      std::printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+      failures++; \
+    } \
+  } while (0)
+
+#define CHECK_EQ(a, b) \
+  do { \
+    auto va = (a); \
+    auto vb = (b); \
+    if (!(va == vb)) { \
+      std::printf("%s:%d: CHECK_EQ failed: %s == %s (%lld vs %lld)\n", __FILE__, __LINE__, #a, #b, (long long) va, \
+                  (long long) vb); \
+      failures++; \
+    } \
+  } while (0)
+
+static const uint16_t SAMPLE_RATES[] = {50, 100, 200, 400, 800, 1000, 1600, 3200};
+
+// 芯片的I2C寄存器模型：寄存器地址自动递增，FIFO_DATA处不递增而是按样本吐出FIFO内容。
+// 32个样本槽、5位读写指针，满时丢弃新样本并递增OVF_COUNTER（FIFO_ROLLOVER_EN=0）。
+// 激活的时隙数和分辨率都取自驱动写入的MODE_CONFIG、MULTI_LED_CTRL、SPO2_CONFIG
+class FakeMAX30105 : public i2c::I2CBus {
+ public:
+  static const uint8_t ADDRESS = 0x57;
+
+  FakeMAX30105() { this->reset_(); }
+
+  i2c::ErrorCode write(uint8_t address, const uint8_t *buffer, size_t len, bool /*stop*/) override {
+    if (address != ADDRESS) {
+      return i2c::ERROR_NOT_ACKNOWLEDGED;
+    }
+    if (len == 0) {
+      return i2c::ERROR_OK;
+    }
+    this->pointer_ = buffer[0];
+    for (size_t i = 1; i < len; i++) {
+      this->write_reg_(this->pointer_++, buffer[i]);
+    }
+    return i2c::ERROR_OK;
+  }
+
+  i2c::ErrorCode read(uint8_t address, uint8_t *buffer, size_t len) override {
+    if (address != ADDRESS) {
+      return i2c::ERROR_NOT_ACKNOWLEDGED;
+    }
+    for (size_t i = 0; i < len; i++) {
+      if (this->pointer_ == 0x07) {
+        buffer[i] = this->read_fifo_byte_();
+      } else {
+        buffer[i] = this->read_reg_(this->pointer_++);
+      }
+    }
+    return i2c::ERROR_OK;
+  }
+
+  uint8_t active_leds() const {
+    switch (this->regs_[0x09] & 0x07) {
+      case 0x02:
+        return 1;
+      case 0x03:
+        return 2;
+      case 0x07: {
+        uint8_t leds = 0;
+        while (leds < MAX30105_MAX_LEDS && ((this->regs_[0x11 + leds / 2] >> (leds % 2 * 4)) & 0x07) != 0) {
+          leds++;
+        }
+        return leds;
+      }
+      default:
+        return 0;
+    }
+  }
+
+  // 写入一个样本，返回是否因FIFO满被丢弃
+  bool produce(const uint32_t *values) {
+    if (this->full_) {
+      if (this->ovf_ < 0x1F) {
+        this->ovf_++;
+      }
+      return false;
+    }
+    uint8_t shift = 3 - (this->regs_[0x0A] & 0x03);
+    uint8_t *slot = this->slots_[this->wr_];
+    for (uint8_t i = 0; i < this->active_leds(); i++) {
+      // 低分辨率时数据左对齐到18位，高6位是芯片不保证的杂位
+      uint32_t raw = ((values[i] << shift) & 0x03FFFF) | 0xFC0000;
+      slot[i * 3] = raw >> 16;
+      slot[i * 3 + 1] = raw >> 8;
+      slot[i * 3 + 2] = raw;
+    }
+    this->wr_ = (this->wr_ + 1) & (MAX30105_FIFO_DEPTH - 1);
+    this->full_ = this->wr_ == this->rd_;
+    return true;
+  }
+
+ protected:
+  void reset_() {
+    std::fill(std::begin(this->regs_), std::end(this->regs_), 0);
+    this->regs_[0xFF] = 0x15;  // PART_ID
+    this->wr_ = this->rd_ = this->ovf_ = 0;
+    this->full_ = false;
+    this->fifo_byte_ = 0;
+  }
+
+  void write_reg_(uint8_t addr, uint8_t value) {
+    switch (addr) {
+      case 0x04:
+        this->wr_ = value & 0x1F;
+        this->full_ = false;
+        break;
+      case 0x05:
+        this->ovf_ = value & 0x1F;
+        break;
+      case 0x06:
+        this->rd_ = value & 0x1F;
+        this->full_ = false;
+        break;
+      case 0x09:
+        if (value & 0x40) {
+          this->reset_();  // RESET位自动清零，所有寄存器回到上电值
+          return;
+        }
+        this->regs_[addr] = value;
+        break;
+      default:
+        this->regs_[addr] = value;
+    }
+  }
+
+  uint8_t read_reg_(uint8_t addr) const {
+    switch (addr) {
+      case 0x04:
+        return this->wr_;
+      case 0x05:
+        return this->ovf_;
+      case 0x06:
+        return this->rd_;
+      default:
+        return this->regs_[addr];
+    }
+  }
+
+  // 每取走一个完整样本读指针加一、溢出计数清零；FIFO空时芯片重复返回当前槽
+  uint8_t read_fifo_byte_() {
+    uint8_t bytes = this->active_leds() * 3;
+    uint8_t value = this->slots_[this->rd_][this->fifo_byte_++];
+    if (this->fifo_byte_ >= bytes) {
+      this->fifo_byte_ = 0;
+      this->rd_ = (this->rd_ + 1) & (MAX30105_FIFO_DEPTH - 1);
+      this->ovf_ = 0;
+      this->full_ = false;
+    }
+    return value;
+  }
+
+  uint8_t regs_[256];
+  uint8_t pointer_{0};
+  uint8_t slots_[MAX30105_FIFO_DEPTH][MAX30105_MAX_LEDS * 3]{};
+  uint8_t wr_;
+  uint8_t rd_;
+  uint8_t ovf_;
+  bool full_;
+  uint8_t fifo_byte_;
+};
+
+// 暴露read_fifo()，其余都走组件原本的setup()和寄存器写入
+class TestMAX30105 : public MAX30105Component {
+ public:
+  using MAX30105Component::read_fifo;
+};
+
+static void configure(TestMAX30105 &component, FakeMAX30105 &chip, MAX30105_MODE mode, uint8_t rate, uint8_t avg,
+                      uint8_t resolution) {
+  component.set_i2c_bus(&chip);
+  component.set_i2c_address(FakeMAX30105::ADDRESS);
+  component.set_mode(mode);
+  component.set_adc_range(MAX30105_ADC_RANGE_4096);
+  component.set_sample_avg((MAX30105_SAMPLE_AVERAGING) avg);
+  component.set_fifo_rollover(false);
+  component.set_fifo_threshold(0x0F);
+  component.set_sample_rate((MAX30105_SAMPLE_RATE) rate);
+  component.set_resolution((MAX30105_RESOLUTION) resolution);
+  component.set_current(0x1F, 0x1F, 0x1F, 0x1F);
+  component.set_interrupts(false, false, false, false, false);
+  component.set_proximity_threshold(0xFF);
+  component.setup();
+  CHECK(!component.is_failed());
+  CHECK_EQ(component.get_active_leds(), chip.active_leds());
+}
+
+// 第n个产生的样本在时隙i上的值
+static uint32_t sample_value(uint32_t n, uint8_t led, uint32_t mask) { return (n * MAX30105_MAX_LEDS + led) & mask; }
+
+static void test_pending_samples() {
+  // 普通情况及5位指针回绕
+  CHECK_EQ(fifo_pending_samples(0, 0, 0), 0);
+  CHECK_EQ(fifo_pending_samples(5, 0, 0), 5);
+  CHECK_EQ(fifo_pending_samples(31, 0, 0), 31);
+  CHECK_EQ(fifo_pending_samples(0, 31, 0), 1);
+  CHECK_EQ(fifo_pending_samples(3, 30, 0), 5);
+  CHECK_EQ(fifo_pending_samples(29, 30, 0), 31);
+  for (uint8_t rd = 0; rd < MAX30105_FIFO_DEPTH; rd++) {
+    for (uint8_t n = 0; n < MAX30105_FIFO_DEPTH; n++) {
+      CHECK_EQ(fifo_pending_samples((rd + n) & 0x1F, rd, 0), n);
+    }
+  }
+  // 读写指针相等：溢出计数为0是空，非0是满
+  for (uint8_t p = 0; p < MAX30105_FIFO_DEPTH; p++) {
+    CHECK_EQ(fifo_pending_samples(p, p, 0), 0);
+    CHECK_EQ(fifo_pending_samples(p, p, 1), MAX30105_FIFO_DEPTH);
+    CHECK_EQ(fifo_pending_samples(p, p, 0x1F), MAX30105_FIFO_DEPTH);
+  }
+  // 指针不相等时溢出计数不影响结果
+  CHECK_EQ(fifo_pending_samples(7, 2, 3), 5);
+}
+
+static void test_decode() {
+  // SPO2_CONFIG[1:0]（LED_PW）决定分辨率：0=15位，1=16位，2=17位，3=18位；驱动取shift = 3 - code
+  for (uint8_t code = 0; code < 4; code++) {
+    uint8_t shift = 3 - code;
+    uint32_t full_scale = (1UL << (15 + code)) - 1;
+    const uint32_t values[] = {0, 1, full_scale / 3, full_scale};
+    for (uint32_t v : values) {
+      uint8_t data[MAX30105_MAX_LEDS * 3];
+      for (uint8_t i = 0; i < MAX30105_MAX_LEDS; i++) {
+        uint32_t led = (v + i) & full_scale;
+        uint32_t raw = ((led << shift) & 0x03FFFF) | 0xFC0000;  // 高6位置1，验证被屏蔽
+        data[i * 3] = raw >> 16;
+        data[i * 3 + 1] = raw >> 8;
+        data[i * 3 + 2] = raw;
+      }
+      MAX30105Sample sample{};
+      decode_fifo_sample(data, MAX30105_MAX_LEDS, shift, sample);
+      for (uint8_t i = 0; i < MAX30105_MAX_LEDS; i++) {
+        CHECK_EQ(sample.led[i], (v + i) & full_scale);
+      }
+    }
+  }
+  // 只解码激活的时隙，其余保持不变
+  uint8_t data[6] = {0x01, 0x23, 0x45, 0x02, 0x34, 0x56};
+  MAX30105Sample sample{};
+  sample.led[2] = 0xDEAD;
+  decode_fifo_sample(data, 2, 0, sample);
+  CHECK_EQ(sample.led[0], 0x012345u);
+  CHECK_EQ(sample.led[1], 0x023456u);
+  CHECK_EQ(sample.led[2], 0xDEADu);
+}
+
+static void test_sample_period() {
+  for (uint8_t rate = 0; rate < 8; rate++) {
+    for (uint8_t avg = 0; avg < 8; avg++) {
+      // SMP_AVE编码5、6、7都是32次平均
+      uint32_t averaging = 1UL << (avg > 5 ? 5 : avg);
+      uint32_t expected = 1000000UL * averaging / SAMPLE_RATES[rate];
+      CHECK_EQ(fifo_sample_period_us(rate, avg), expected);
+    }
+  }
+  CHECK_EQ(fifo_sample_period_us(0, 0), 20000u);  // 50 Hz
+  CHECK_EQ(fifo_sample_period_us(7, 0), 312u);    // 3200 Hz
+  CHECK_EQ(fifo_sample_period_us(0, 5), 640000u);
+  // 采样率编码只取低3位
+  CHECK_EQ(fifo_sample_period_us(8 + 1, 0), fifo_sample_period_us(1, 0));
+}
+
+struct DrainResult {
+  uint32_t produced;
+  uint32_t delivered;
+  uint32_t lost;
+  bool in_order;
+  double read_ns_per_sample;
+};
+
+// 按采样周期模拟芯片写FIFO，每poll_us调用一次组件的read_fifo()，
+// 以组件样本缓冲区的计数核对送达的样本数，并逐个核对数值和顺序
+static DrainResult simulate(uint8_t rate, uint8_t avg, MAX30105_MODE mode, uint8_t resolution, uint32_t poll_us,
+                            uint32_t duration_us) {
+  FakeMAX30105 chip;
+  TestMAX30105 component;
+  now_us = 0;
+  configure(component, chip, mode, rate, avg, resolution);
+  uint8_t leds = component.get_active_leds();
+  uint32_t mask = (1UL << (15 + resolution)) - 1;
+  uint32_t period = fifo_sample_period_us(rate, avg);
+  DrainResult result{0, 0, 0, true, 0.0};
+  std::chrono::nanoseconds read_time{0};
+  uint32_t next_sample = period;
+  for (now_us = poll_us; now_us <= duration_us; now_us += poll_us) {
+    for (; next_sample <= now_us; next_sample += period) {
+      uint32_t values[MAX30105_MAX_LEDS];
+      for (uint8_t i = 0; i < leds; i++) {
+        values[i] = sample_value(result.produced, i, mask);
+      }
+      if (!chip.produce(values)) {
+        result.lost++;
+      }
+      result.produced++;
+    }
+    uint32_t before = component.get_sample_count();
+    auto start = std::chrono::steady_clock::now();
+    component.read_fifo();
+    read_time += std::chrono::steady_clock::now() - start;
+    uint32_t after = component.get_sample_count();
+    // 没丢样本时，第k个送达的样本就是第k个产生的样本
+    if (result.lost == 0) {
+      for (uint32_t n = before; n < after; n++) {
+        const MAX30105Sample &sample = component.get_sample_buffer()[n % MAX30105_SAMPLE_BUFFER_SIZE];
+        for (uint8_t i = 0; i < leds; i++) {
+          if (sample.led[i] != sample_value(n, i, mask)) {
+            result.in_order = false;
+          }
+        }
+      }
+    }
+    result.delivered += after - before;
+  }
+  if (result.delivered > 0) {
+    result.read_ns_per_sample = double(read_time.count()) / result.delivered;
+  }
+  return result;
+}
+
+static void test_drain_loop() {
+  const MAX30105_MODE modes[] = {MAX30105_MODE_HR_ONLY, MAX30105_MODE_SPO2_HR, MAX30105_MODE_MULTI_LED};
+  for (uint8_t rate = 0; rate < 8; rate++) {
+    for (uint8_t avg = 0; avg < 6; avg++) {
+      uint32_t period = fifo_sample_period_us(rate, avg);
+      // 每积累16个样本读一次（相当于FIFO_A_FULL中断），不应丢样本
+      uint32_t poll_us = period * 16;
+      uint32_t duration = poll_us * 40;
+      for (MAX30105_MODE mode : modes) {
+        DrainResult r = simulate(rate, avg, mode, MAX30105_RESOLUTION_18_BIT, poll_us, duration);
+        CHECK_EQ(r.lost, 0u);
+        CHECK_EQ(r.delivered, r.produced);
+        CHECK(r.in_order);
+      }
+      // 固定20ms轮询，快速配置下FIFO会满：读到的 + 丢弃的 = 产生的，满FIFO要读出32个
+      DrainResult r = simulate(rate, avg, MAX30105_MODE_MULTI_LED, MAX30105_RESOLUTION_17_BIT, 20000, 2000000);
+      CHECK_EQ(r.delivered + r.lost, r.produced);
+      if (20000 / period < MAX30105_FIFO_DEPTH) {
+        CHECK_EQ(r.lost, 0u);
+        CHECK(r.in_order);
+      }
+      std::printf("rate %4u Hz avg %2u: period %6u us, 20ms poll delivered %5u lost %5u, read_fifo %.1f ns/sample\n",
+                  SAMPLE_RATES[rate], 1u << avg, period, r.delivered, r.lost, r.read_ns_per_sample);
+    }
+  }
+}
+
+static void test_full_fifo() {
+  // 恰好写满后再多写一个：指针相等、OVF=1，read_fifo()必须读出全部32个样本
+  FakeMAX30105 chip;
+  TestMAX30105 component;
+  configure(component, chip, MAX30105_MODE_SPO2_HR, 0, 0, MAX30105_RESOLUTION_18_BIT);
+  uint32_t values[2] = {0, 0};
+  for (uint32_t i = 0; i < MAX30105_FIFO_DEPTH + 1; i++) {
+    values[0] = i;
+    values[1] = i + 1000;
+    chip.produce(values);
+  }
+  uint32_t before = component.get_sample_count();
+  component.read_fifo();
+  CHECK_EQ(component.get_sample_count() - before, MAX30105_FIFO_DEPTH);
+  for (uint8_t k = 0; k < MAX30105_FIFO_DEPTH; k++) {
+    const MAX30105Sample &sample = component.get_sample_buffer()[(before + k) % MAX30105_SAMPLE_BUFFER_SIZE];
+    CHECK_EQ(sample.led[0], k);
+    CHECK_EQ(sample.led[1], k + 1000u);
+  }
+  // 读空后再读不应产生样本
+  before = component.get_sample_count();
+  component.read_fifo();
+  CHECK_EQ(component.get_sample_count(), before);
+}
+
+int main() {
+  test_pending_samples();
+  test_decode();
+  test_sample_period();
+  test_full_fifo();
+  test_drain_loop();
+  if (failures > 0) {
+    std::printf("%d check(s) failed\n", failures);
+    return 1;
+  }
+  std::printf("all checks passed\n");
+  return 0;
+}
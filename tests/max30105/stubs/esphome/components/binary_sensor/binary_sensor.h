@@ -0,0 +1,14 @@
+#pragma once
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace binary_sensor {
+
+class BinarySensor {
+ public:
+  void publish_state(bool state) { this->state = state; }
+  bool state{false};
+};
+
+}  // namespace binary_sensor
+}  // namespace esphome
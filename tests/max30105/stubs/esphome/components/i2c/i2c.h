@@ -0,0 +1,85 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 主机测试用的I2CDevice：与esphome相同，寄存器读写都转成对总线的write/read，总线由测试代码实现芯片模型
+namespace esphome {
+namespace i2c {
+
+enum ErrorCode {
+  ERROR_OK = 0,
+  ERROR_INVALID_ARGUMENT = 1,
+  ERROR_NOT_ACKNOWLEDGED = 2,
+  ERROR_TIMEOUT = 3,
+  ERROR_NOT_INITIALIZED = 4,
+  ERROR_TOO_LARGE = 5,
+  ERROR_UNKNOWN = 6,
+};
+
+class I2CBus {
+ public:
+  virtual ~I2CBus() = default;
+  virtual ErrorCode read(uint8_t address, uint8_t *buffer, size_t len) = 0;
+  virtual ErrorCode write(uint8_t address, const uint8_t *buffer, size_t len, bool stop) = 0;
+};
+
+class I2CDevice;
+
+class I2CRegister {
+ public:
+  I2CRegister &operator=(uint8_t value);
+  uint8_t get() const;
+
+ protected:
+  friend class I2CDevice;
+  I2CRegister(I2CDevice *parent, uint8_t a_register) : parent_(parent), register_(a_register) {}
+  I2CDevice *parent_;
+  uint8_t register_;
+};
+
+class I2CDevice {
+ public:
+  void set_i2c_address(uint8_t address) { this->address_ = address; }
+  void set_i2c_bus(I2CBus *bus) { this->bus_ = bus; }
+
+  I2CRegister reg(uint8_t a_register) { return {this, a_register}; }
+
+  ErrorCode read(uint8_t *data, size_t len) { return this->bus_->read(this->address_, data, len); }
+  ErrorCode write(const uint8_t *data, size_t len, bool stop = true) {
+    return this->bus_->write(this->address_, data, len, stop);
+  }
+  ErrorCode read_register(uint8_t a_register, uint8_t *data, size_t len, bool stop = true) {
+    ErrorCode err = this->write(&a_register, 1, stop);
+    if (err != ERROR_OK) {
+      return err;
+    }
+    return this->read(data, len);
+  }
+  ErrorCode write_register(uint8_t a_register, const uint8_t *data, size_t len, bool stop = true) {
+    std::vector<uint8_t> buffer(len + 1);
+    buffer[0] = a_register;
+    for (size_t i = 0; i < len; i++) {
+      buffer[i + 1] = data[i];
+    }
+    return this->write(buffer.data(), buffer.size(), stop);
+  }
+
+ protected:
+  uint8_t address_{0x00};
+  I2CBus *bus_{nullptr};
+};
+
+inline I2CRegister &I2CRegister::operator=(uint8_t value) {
+  this->parent_->write_register(this->register_, &value, 1);
+  return *this;
+}
+
+inline uint8_t I2CRegister::get() const {
+  uint8_t value = 0x00;
+  this->parent_->read_register(this->register_, &value, 1);
+  return value;
+}
+
+}  // namespace i2c
+}  // namespace esphome
@@ -0,0 +1,37 @@
+#pragma once
+#include "esphome/core/component.h"
+#include "esphome/core/helpers.h"
+
+namespace esphome {
+
+template<typename T, typename... X> class TemplatableValue {
+ public:
+  TemplatableValue() = default;
+  TemplatableValue(T value) : value_(value) {}
+  T value(X... x) { return this->value_; }
+
+ protected:
+  T value_{};
+};
+
+#define TEMPLATABLE_VALUE_(type, name) \
+ protected: \
+  TemplatableValue<type, Ts...> name##_{}; \
+\
+ public: \
+  template<typename V> void set_##name(V name) { this->name##_ = name; }
+
+#define TEMPLATABLE_VALUE(type, name) TEMPLATABLE_VALUE_(type, name)
+
+template<typename... Ts> class Trigger {
+ public:
+  void trigger(Ts... x) {}
+};
+
+template<typename... Ts> class Action {
+ public:
+  virtual ~Action() = default;
+  virtual void play(Ts... x) = 0;
+};
+
+}  // namespace esphome
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
+
+// 主机测试用：调度器不运行，set_timeout/set_interval的回调不会被调用
+namespace esphome {
+
+namespace setup_priority {
+static const float DATA = 600.0f;
+}  // namespace setup_priority
+
+class Component {
+ public:
+  virtual ~Component() = default;
+  virtual void setup() {}
+  virtual void loop() {}
+  virtual void dump_config() {}
+  virtual float get_setup_priority() const { return 0.0f; }
+  void mark_failed() { this->failed_ = true; }
+  bool is_failed() const { return this->failed_; }
+
+ protected:
+  void set_timeout(const std::string &name, uint32_t timeout, std::function<void()> &&f) {}
+  void set_interval(const std::string &name, uint32_t interval, std::function<void()> &&f) {}
+  bool failed_{false};
+};
+
+class PollingComponent : public Component {
+ public:
+  virtual void update() = 0;
+};
+
+}  // namespace esphome
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+
+// 主机测试用：时间由测试代码推进，中断引脚不会触发
+#define IRAM_ATTR
+
+namespace esphome {
+
+uint32_t millis();
+uint32_t micros();
+
+namespace gpio {
+enum Flags : uint8_t { FLAG_NONE = 0x00, FLAG_INPUT = 0x01, FLAG_OUTPUT = 0x02, FLAG_PULLUP = 0x08 };
+enum InterruptType : uint8_t { INTERRUPT_RISING_EDGE = 1, INTERRUPT_FALLING_EDGE = 2, INTERRUPT_ANY_EDGE = 3 };
+}  // namespace gpio
+
+class InternalGPIOPin {
+ public:
+  void setup() {}
+  void pin_mode(int flags) {}
+  template<typename T> void attach_interrupt(void (*func)(T *), T *arg, gpio::InterruptType type) const {}
+};
+
+}  // namespace esphome
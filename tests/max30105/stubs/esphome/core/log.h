@@ -0,0 +1,15 @@
+#pragma once
+#include <cinttypes>
+
+// 主机测试用：日志全部丢弃
+#define ESP_LOGE(tag, ...) ((void) (tag))
+#define ESP_LOGW(tag, ...) ((void) (tag))
+#define ESP_LOGI(tag, ...) ((void) (tag))
+#define ESP_LOGD(tag, ...) ((void) (tag))
+#define ESP_LOGV(tag, ...) ((void) (tag))
+#define ESP_LOGCONFIG(tag, ...) ((void) (tag))
+#define LOG_SENSOR(prefix, type, obj) ((void) (obj))
+#define LOG_BINARY_SENSOR(prefix, type, obj) ((void) (obj))
+#define LOG_UPDATE_INTERVAL(this) ((void) (this))
+#define LOG_I2C_DEVICE(this) ((void) (this))
+#define LOG_PIN(prefix, pin) ((void) (pin))
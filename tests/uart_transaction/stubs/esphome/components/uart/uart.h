@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+// 主机测试用的UARTDevice：接收队列由测试代码填充，发送的字节记录在tx中
+namespace esphome {
+namespace uart {
+
+class UARTDevice {
+ public:
+  void write_array(const uint8_t *data, size_t len) {
+    this->tx.insert(this->tx.end(), data, data + len);
+    if (this->on_write) {
+      this->on_write(data, len);  // 模拟设备立即应答
+    }
+  }
+  bool read_byte(uint8_t *data) {
+    if (this->rx.empty()) {
+      return false;
+    }
+    *data = this->rx.front();
+    this->rx.pop_front();
+    return true;
+  }
+  int read() {
+    uint8_t c;
+    return this->read_byte(&c) ? c : -1;
+  }
+  int available() { return (int) this->rx.size(); }
+
+  std::deque<uint8_t> rx;
+  std::vector<uint8_t> tx;
+  std::function<void(const uint8_t *data, size_t len)> on_write;
+};
+
+}  // namespace uart
+}  // namespace esphome
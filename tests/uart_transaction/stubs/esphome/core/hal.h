@@ -0,0 +1,7 @@
+#pragma once
+#include <cstdint>
+
+// 主机测试用：时间由测试代码推进
+namespace esphome {
+uint32_t millis();
+}  // namespace esphome
@@ -0,0 +1,9 @@
+#pragma once
+#include <cinttypes>
+
+// 主机测试用：日志全部丢弃
+#define ESP_LOGE(tag, ...) ((void) (tag))
+#define ESP_LOGW(tag, ...) ((void) (tag))
+#define ESP_LOGI(tag, ...) ((void) (tag))
+#define ESP_LOGD(tag, ...) ((void) (tag))
+#define ESP_LOGV(tag, ...) ((void) (tag))
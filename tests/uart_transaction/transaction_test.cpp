@@ -0,0 +1,198 @@
+// uart_transaction的主机测试：帧头重同步、定长/变长帧、校验、超时、只发不收，以及在回调里发起下一个请求
+#include <cstdio>
+#include <vector>
+#include "esphome/core/hal.h"
+#include "uart_transaction/uart_transaction.h"
+
+using namespace esphome;
+using namespace esphome::uart_transaction;
+
+static uint32_t now_ms = 0;
+namespace esphome {
+uint32_t millis() { return now_ms; }
+}  // namespace esphome
+
+static int failures = 0;
+
+#define CHECK(cond) \
+  do { \
+    if (!(cond)) { \
+      std::printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+      failures++; \
+    } \
+  } while (0)
+
+// 与WS-Z读数应答相同：FF 86 + 6字节 + 校验（bytes[1..7]之和取反加一）
+static const FrameDescriptor FIXED = {{0xFF, 0x86}, 2, 9, CHECKSUM_SUM_COMPLEMENT, 1};
+// 与KANFUR应答相同：16 + 长度 + 命令 + 数据 + 校验，总长 = 长度 + 3
+static const FrameDescriptor PREFIXED = {{0x16, 0x00}, 1, 32, CHECKSUM_SUM_COMPLEMENT, 0, 1, 3};
+static const FrameDescriptor SHORT = {{0x16, 0x00}, 1, 4, CHECKSUM_NONE, 0};
+
+struct Result {
+  int calls{0};
+  TransactionStatus status{TRANSACTION_OK};
+  std::vector<uint8_t> data;
+};
+
+static ResponseCallback record(Result &result) {
+  return [&result](TransactionStatus status, const uint8_t *data, uint8_t len) {
+    result.calls++;
+    result.status = status;
+    result.data.assign(data, data + len);
+  };
+}
+
+static std::vector<uint8_t> fixed_frame(uint8_t value) {
+  std::vector<uint8_t> frame = {0xFF, 0x86, value, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+  frame[8] = compute_checksum(CHECKSUM_SUM_COMPLEMENT, frame.data(), 8, 1);
+  return frame;
+}
+
+static void push(uart::UARTDevice &device, const std::vector<uint8_t> &bytes) {
+  device.rx.insert(device.rx.end(), bytes.begin(), bytes.end());
+}
+
+static void test_checksum() {
+  const uint8_t data[] = {0x11, 0x01, 0x01};
+  CHECK(compute_checksum(CHECKSUM_SUM_COMPLEMENT, data, 3) == 0xED);
+  CHECK(compute_checksum(CHECKSUM_SUM, data, 3, 1) == 0x02);
+  CHECK(compute_checksum(CHECKSUM_NONE, data, 3) == 0);
+}
+
+static void test_fixed_frame_with_resync() {
+  uart::UARTDevice device;
+  UARTTransaction transaction(&device);
+  Result result;
+  const uint8_t request[] = {0x01, 0x02};
+  CHECK(transaction.send(request, 2, &FIXED, record(result)));
+  CHECK(device.tx.size() == 2);
+  // 帧头前的杂字节以及一个假帧头都应被跳过；分两次到达
+  std::vector<uint8_t> frame = fixed_frame(0x42);
+  push(device, {0x00, 0xFF, 0x01, 0xFF});
+  push(device, std::vector<uint8_t>(frame.begin(), frame.begin() + 4));
+  transaction.loop();
+  CHECK(result.calls == 0);
+  push(device, std::vector<uint8_t>(frame.begin() + 4, frame.end()));
+  transaction.loop();
+  CHECK(result.calls == 1);
+  CHECK(result.status == TRANSACTION_OK);
+  CHECK(result.data == frame);
+  CHECK(!transaction.is_busy());
+}
+
+static void test_checksum_error_and_timeout() {
+  uart::UARTDevice device;
+  UARTTransaction transaction(&device);
+  Result result;
+  const uint8_t request[] = {0x01};
+  transaction.send(request, 1, &FIXED, record(result));
+  std::vector<uint8_t> frame = fixed_frame(0x10);
+  frame[8] ^= 0x01;
+  push(device, frame);
+  transaction.loop();
+  CHECK(result.calls == 1);
+  CHECK(result.status == TRANSACTION_CHECKSUM_ERROR);
+
+  transaction.send(request, 1, &FIXED, record(result), 50);
+  push(device, {0xFF, 0x86, 0x01});
+  transaction.loop();
+  CHECK(result.calls == 1);
+  now_ms += 51;
+  transaction.loop();
+  CHECK(result.calls == 2);
+  CHECK(result.status == TRANSACTION_TIMEOUT);
+  CHECK(result.data.size() == 3);
+}
+
+static void test_length_prefixed() {
+  uart::UARTDevice device;
+  UARTTransaction transaction(&device);
+  Result result;
+  const uint8_t request[] = {0x11, 0x01, 0x01, 0xED};
+  transaction.send(request, 4, &PREFIXED, record(result));
+  // 长度5：命令 + 4字节数据，总长8，之后的字节不属于本帧
+  std::vector<uint8_t> frame = {0x16, 0x05, 0x01, 0x02, 0x58, 0x00, 0x00, 0x00};
+  frame[7] = compute_checksum(CHECKSUM_SUM_COMPLEMENT, frame.data(), 7);
+  push(device, frame);
+  push(device, {0xAA, 0xBB});
+  transaction.loop();
+  CHECK(result.calls == 1);
+  CHECK(result.status == TRANSACTION_OK);
+  CHECK(result.data == frame);
+
+  // 长度字节超出描述的最大长度
+  transaction.send(request, 4, &PREFIXED, record(result));
+  push(device, {0x16, 0xF0});
+  transaction.loop();
+  CHECK(result.calls == 2);
+  CHECK(result.status == TRANSACTION_MALFORMED);
+}
+
+static void test_fire_and_forget_queue() {
+  uart::UARTDevice device;
+  UARTTransaction transaction(&device);
+  Result first;
+  Result second;
+  const uint8_t a[] = {0xA1};
+  const uint8_t b[] = {0xB2};
+  CHECK(transaction.send(a, 1, nullptr, record(first)));
+  CHECK(first.calls == 1);  // 只发不收的请求立即完成
+  CHECK(transaction.send(b, 1, &SHORT, record(second)));
+  CHECK(device.tx.size() == 2);
+  // 等待应答期间后续请求排队，不立即发送；队列满时拒绝
+  for (uint8_t i = 1; i < UART_TRANSACTION_QUEUE_SIZE; i++) {
+    CHECK(transaction.send(a, 1, nullptr, nullptr));
+  }
+  CHECK(!transaction.send(a, 1, nullptr, nullptr));
+  CHECK(device.tx.size() == 2);
+  push(device, {0x16, 0x01, 0x02, 0x03});
+  transaction.loop();
+  CHECK(second.calls == 1);
+  CHECK(device.tx.size() == 2 + UART_TRANSACTION_QUEUE_SIZE - 1);
+  CHECK(!transaction.is_busy());
+}
+
+static void test_send_from_callback() {
+  // 设备收到请求后立即应答：回调里发出的第二个请求，其应答在同一次loop()中就已可读，
+  // 必须按第二个请求的帧描述解析
+  uart::UARTDevice device;
+  UARTTransaction transaction(&device);
+  const std::vector<uint8_t> first_frame = fixed_frame(0x07);
+  const std::vector<uint8_t> second_frame = {0x16, 0x01, 0x03, 0xE6};
+  device.on_write = [&](const uint8_t *data, size_t len) {
+    push(device, data[0] == 0x01 ? first_frame : second_frame);
+  };
+  Result first;
+  Result second;
+  const uint8_t request1[] = {0x01};
+  const uint8_t request2[] = {0x02};
+  transaction.send(request1, 1, &FIXED,
+                   [&](TransactionStatus status, const uint8_t *data, uint8_t len) {
+                     record(first)(status, data, len);
+                     transaction.send(request2, 1, &SHORT, record(second));
+                   });
+  transaction.loop();
+  CHECK(first.calls == 1);
+  CHECK(first.status == TRANSACTION_OK);
+  CHECK(first.data == first_frame);
+  transaction.loop();
+  CHECK(second.calls == 1);
+  CHECK(second.status == TRANSACTION_OK);
+  CHECK(second.data == second_frame);
+  CHECK(!transaction.is_busy());
+}
+
+int main() {
+  test_checksum();
+  test_fixed_frame_with_resync();
+  test_checksum_error_and_timeout();
+  test_length_prefixed();
+  test_fire_and_forget_queue();
+  test_send_from_callback();
+  if (failures > 0) {
+    std::printf("%d check(s) failed\n", failures);
+    return 1;
+  }
+  std::printf("all checks passed\n");
+  return 0;
+}